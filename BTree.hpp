@@ -0,0 +1,604 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_BTREE_HPP
+#define TREESITERATORS_CPP_BTREE_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>  // For std::less
+#include <iterator>
+#include <memory>  // For std::uninitialized_move, std::destroy
+#include <new>
+#include <utility>
+#include <vector>
+#include "KeySearch.hpp"
+#include "TreeTraversal.hpp"  // For TraversalRange
+
+/**
+ * @brief An ordered set of keys in a B-tree whose nodes hold up to D - 1 keys and D children inline.
+ *
+ * Where Tree<T, D> allocates one node per key, a B-tree node stores its
+ * keys side by side in one array and its children in a fixed array of
+ * pointers, so a lookup touches O(log_D n) nodes and reads each one as a
+ * few contiguous cache lines. Leaves, which hold most of the keys, have no
+ * child array at all. Nodes are aligned to a cache line; for D = 16 a leaf
+ * of ints is exactly one line.
+ *
+ * Inserts split full nodes on the way down, so they never walk back up.
+ * Within a node, keys are found with KeySearch: SIMD comparisons over the
+ * key array for arithmetic keys under std::less, a binary search otherwise.
+ * Iteration uses the same vocabulary as Tree: a bidirectional in-order
+ * iterator over the keys and a breadth-first iterator over the nodes, each
+ * with a begin_/end_ pair and a lazy range.
+ *
+ * Not safe for concurrent writers. Keys are not erased.
+ *
+ * @tparam T The key type; it needs no default constructor.
+ * @tparam D The fan-out: a node holds at most D - 1 keys and D children.
+ * @tparam Compare The strict weak order of the keys; must be default-constructible.
+ */
+template<typename T, unsigned int D = 16, typename Compare = std::less<T>>
+class BTree {
+    static_assert(D >= 4, "A B-tree node needs room for at least three keys.");
+    static_assert(D <= 65536, "The key count of a node is stored in 16 bits.");
+
+public:
+    static constexpr std::size_t CACHE_LINE = 64;    ///< The alignment of every node.
+    static constexpr std::size_t MAX_KEYS = D - 1;   ///< The capacity of a node.
+
+    /**
+     * @brief A node: its keys, contiguous and in order, and for inner nodes the subtrees around them.
+     */
+    struct alignas(CACHE_LINE) Node {
+        std::uint16_t count = 0;  ///< The number of keys.
+        bool leaf = true;         ///< Whether the node has no children.
+
+        /**
+         * @brief Get the keys; the first size() of them are valid.
+         */
+        const T *keys() const {
+            return std::launder(reinterpret_cast<const T *>(storage));
+        }
+
+        /**
+         * @brief Get the number of keys.
+         */
+        std::size_t size() const {
+            return count;
+        }
+
+        /**
+         * @brief Get a child: the subtree between keys()[i - 1] and keys()[i].
+         *
+         * @param i The index of the child, up to size(); the node must not be a leaf.
+         */
+        const Node *child(std::size_t i) const;
+
+    private:
+        friend class BTree;
+
+        alignas(T) unsigned char storage[MAX_KEYS * sizeof(T)];  ///< Room for the keys, constructed in place.
+
+        T *slots() {
+            return std::launder(reinterpret_cast<T *>(storage));
+        }
+    };
+
+    /**
+     * @brief An inner node, which also owns its size() + 1 children.
+     */
+    struct Inner : Node {
+        Node *children[D] = {};  ///< The subtrees; the first size() + 1 are set.
+
+        Inner() {
+            this->leaf = false;
+        }
+    };
+
+    /**
+     * @brief Bidirectional iterator over the keys in order.
+     *
+     * Holds the path from the root with the position taken at every node: the
+     * current key's index in the last node, the index of the child descended
+     * into at the others. Memory is proportional to the height, and a full
+     * sweep in either direction costs amortized O(1) per key.
+     */
+    class InOrderIterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        /**
+         * @brief Construct a detached end iterator.
+         */
+        InOrderIterator() = default;
+
+        reference operator*() const {
+            return path.back().node->keys()[path.back().index];
+        }
+
+        pointer operator->() const {
+            return &**this;
+        }
+
+        /**
+         * @brief Move to the next key, or to the end after the largest one.
+         */
+        InOrderIterator &operator++() {
+            Frame &top = path.back();
+            if (!top.node->leaf) {
+                top.index += 1;  // the key is done; its right subtree comes next
+                descend_first(top.node->child(top.index));
+                return *this;
+            }
+            if (++top.index < top.node->size())
+                return *this;
+            do {
+                path.pop_back();
+            } while (!path.empty() && path.back().index == path.back().node->size());
+            return *this;
+        }
+
+        InOrderIterator operator++(int) {
+            InOrderIterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        /**
+         * @brief Move to the previous key; from the end, to the largest key.
+         */
+        InOrderIterator &operator--() {
+            if (path.empty()) {
+                if (*root)
+                    descend_last(*root);
+                return *this;
+            }
+            Frame &top = path.back();
+            if (!top.node->leaf) {
+                descend_last(top.node->child(top.index));  // the left subtree of the key
+                return *this;
+            }
+            if (top.index > 0) {
+                --top.index;
+                return *this;
+            }
+            do {
+                path.pop_back();
+            } while (!path.empty() && path.back().index == 0);
+            if (!path.empty())
+                --path.back().index;  // from the child index to the key before it
+            return *this;
+        }
+
+        InOrderIterator operator--(int) {
+            InOrderIterator next = *this;
+            --*this;
+            return next;
+        }
+
+        bool operator==(const InOrderIterator &other) const {
+            if (path.empty() || other.path.empty())
+                return path.empty() == other.path.empty();
+            return path.back().node == other.path.back().node && path.back().index == other.path.back().index;
+        }
+
+        bool operator!=(const InOrderIterator &other) const {
+            return !(*this == other);
+        }
+
+    private:
+        friend class BTree;
+
+        /**
+         * @brief A node on the path and the position taken in it.
+         */
+        struct Frame {
+            const Node *node;
+            std::size_t index;
+        };
+
+        Node *const *root = nullptr;  ///< The tree's root slot, so the end can step back.
+        std::vector<Frame> path;      ///< The path from the root; empty at the end.
+
+        explicit InOrderIterator(Node *const *root) : root(root) {}
+
+        void descend_first(const Node *node) {
+            while (true) {
+                path.push_back(Frame{node, 0});
+                if (node->leaf)
+                    return;
+                node = node->child(0);
+            }
+        }
+
+        void descend_last(const Node *node) {
+            while (!node->leaf) {
+                path.push_back(Frame{node, node->size()});
+                node = node->child(node->size());
+            }
+            path.push_back(Frame{node, node->size() - 1});
+        }
+    };
+
+    /**
+     * @brief Forward iterator over the nodes in breadth-first order.
+     */
+    class BFSIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = Node;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Node *;
+        using reference = const Node &;
+
+        /**
+         * @brief Construct the end iterator.
+         */
+        BFSIterator() = default;
+
+        /**
+         * @brief Start at a root.
+         *
+         * @param root The root node, or null for an empty traversal.
+         */
+        explicit BFSIterator(const Node *root) {
+            if (root)
+                queue.push_back(root);
+        }
+
+        reference operator*() const {
+            return *queue.front();
+        }
+
+        pointer operator->() const {
+            return queue.front();
+        }
+
+        BFSIterator &operator++() {
+            const Node *node = queue.front();
+            queue.pop_front();
+            if (!node->leaf) {
+                for (std::size_t i = 0; i <= node->size(); ++i) {
+                    queue.push_back(node->child(i));
+                }
+            }
+            return *this;
+        }
+
+        BFSIterator operator++(int) {
+            BFSIterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        bool operator==(const BFSIterator &other) const {
+            if (queue.empty() || other.queue.empty())
+                return queue.empty() == other.queue.empty();
+            return queue.front() == other.queue.front();
+        }
+
+        bool operator!=(const BFSIterator &other) const {
+            return !(*this == other);
+        }
+
+    private:
+        std::deque<const Node *> queue;  ///< The current node first, then the frontier.
+    };
+
+    BTree() = default;
+
+    BTree(BTree &&other) noexcept : root(std::exchange(other.root, nullptr)), count(std::exchange(other.count, 0)),
+                                    levels(std::exchange(other.levels, 0)) {}
+
+    BTree &operator=(BTree &&other) noexcept {
+        if (this != &other) {
+            clear();
+            root = std::exchange(other.root, nullptr);
+            count = std::exchange(other.count, 0);
+            levels = std::exchange(other.levels, 0);
+        }
+        return *this;
+    }
+
+    BTree(const BTree &) = delete;
+    BTree &operator=(const BTree &) = delete;
+
+    ~BTree() {
+        clear();
+    }
+
+    /**
+     * @brief Insert a key, unless an equivalent key is already present.
+     *
+     * @param key The key.
+     * @return true If the key was inserted.
+     * @return false If an equivalent key was already present.
+     */
+    bool insert(T key) {
+        if (!root) {
+            root = new Node;
+            levels = 1;
+        } else if (root->size() == MAX_KEYS) {
+            Inner *above = new Inner();
+            above->children[0] = root;
+            root = above;
+            ++levels;
+            split_child(*above, 0);
+        }
+        Node *node = root;
+        while (true) {
+            std::size_t i = rank(*node, key);
+            if (i < node->size() && !less(key, node->keys()[i]))
+                return false;
+            if (node->leaf) {
+                insert_key(*node, i, std::move(key));
+                ++count;
+                return true;
+            }
+            Inner &inner = static_cast<Inner &>(*node);
+            if (inner.children[i]->size() == MAX_KEYS) {
+                split_child(inner, i);
+                const T &middle = inner.keys()[i];
+                if (less(middle, key))
+                    ++i;
+                else if (!less(key, middle))
+                    return false;
+            }
+            node = inner.children[i];
+        }
+    }
+
+    /**
+     * @brief Check whether an equivalent key is present.
+     *
+     * @param key The key.
+     * @return true If the key is present.
+     */
+    bool contains(const T &key) const {
+        const Node *node = root;
+        while (node) {
+            std::size_t i = rank(*node, key);
+            if (i < node->size() && !less(key, node->keys()[i]))
+                return true;
+            node = node->leaf ? nullptr : node->child(i);
+        }
+        return false;
+    }
+
+    /**
+     * @brief Find an equivalent key.
+     *
+     * @param key The key.
+     * @return InOrderIterator An iterator at that key, or end() if there is none.
+     */
+    InOrderIterator find(const T &key) const {
+        InOrderIterator it = lower_bound(key);
+        if (it != end() && !less(key, *it))
+            return it;
+        return end();
+    }
+
+    /**
+     * @brief Get an iterator at the first key not less than a key.
+     *
+     * @param key The key.
+     * @return InOrderIterator The iterator, end() if every key is less.
+     */
+    InOrderIterator lower_bound(const T &key) const {
+        return seek([this, &key](const Node &node) { return rank(node, key); });
+    }
+
+    /**
+     * @brief Get an iterator at the first key greater than a key.
+     *
+     * @param key The key.
+     * @return InOrderIterator The iterator, end() if no key is greater.
+     */
+    InOrderIterator upper_bound(const T &key) const {
+        return seek([this, &key](const Node &node) {
+            return KeySearch<T, Compare>::upper_bound(node.keys(), node.size(), key, less);
+        });
+    }
+
+    /**
+     * @brief Get the keys in [low, high) as a lazy range in key order.
+     *
+     * @param low The smallest key included.
+     * @param high The first key excluded.
+     * @return TraversalRange<InOrderIterator> The range.
+     */
+    TraversalRange<InOrderIterator> range(const T &low, const T &high) const {
+        return TraversalRange<InOrderIterator>(lower_bound(low), lower_bound(high));
+    }
+
+    /** @brief Beginning of the in-order traversal, at the smallest key. */
+    InOrderIterator begin_in_order() const {
+        InOrderIterator it(&root);
+        if (root)
+            it.descend_first(root);
+        return it;
+    }
+
+    /** @brief End of the in-order traversal; it can be decremented to the largest key. */
+    InOrderIterator end_in_order() const { return InOrderIterator(&root); }
+
+    /** @brief Beginning of the breadth-first traversal of the nodes. */
+    BFSIterator begin_bfs_scan() const { return BFSIterator(root); }
+
+    /** @brief End of the breadth-first traversal of the nodes. */
+    BFSIterator end_bfs_scan() const { return BFSIterator(); }
+
+    /** @brief Same as begin_in_order(), so the tree works in range-for and the standard algorithms. */
+    InOrderIterator begin() const { return begin_in_order(); }
+
+    /** @brief Same as end_in_order(). */
+    InOrderIterator end() const { return end_in_order(); }
+
+    /**
+     * @brief Get the keys in order as a lazy range.
+     */
+    TraversalRange<InOrderIterator> in_order() const {
+        return TraversalRange<InOrderIterator>(begin_in_order(), end_in_order());
+    }
+
+    /**
+     * @brief Get the nodes in breadth-first order as a lazy range.
+     */
+    TraversalRange<BFSIterator> bfs() const {
+        return TraversalRange<BFSIterator>(begin_bfs_scan());
+    }
+
+    /**
+     * @brief Get the root node, or null if the tree is empty.
+     */
+    const Node *get_root() const {
+        return root;
+    }
+
+    /**
+     * @brief Get the number of keys.
+     */
+    std::size_t size() const {
+        return count;
+    }
+
+    /**
+     * @brief Check whether the tree has no keys.
+     */
+    bool empty() const {
+        return count == 0;
+    }
+
+    /**
+     * @brief Get the number of levels; every leaf is on the last one.
+     */
+    std::size_t height() const {
+        return levels;
+    }
+
+    /**
+     * @brief Remove every key.
+     */
+    void clear() {
+        std::vector<Node *> pending;
+        if (root)
+            pending.push_back(root);
+        while (!pending.empty()) {
+            Node *node = pending.back();
+            pending.pop_back();
+            if (!node->leaf) {
+                Inner *inner = static_cast<Inner *>(node);
+                pending.insert(pending.end(), inner->children, inner->children + inner->size() + 1);
+            }
+            destroy(node);
+        }
+        root = nullptr;
+        count = 0;
+        levels = 0;
+    }
+
+private:
+    Node *root = nullptr;    ///< Owns the nodes.
+    std::size_t count = 0;   ///< Number of keys.
+    std::size_t levels = 0;  ///< The height.
+    Compare less;            ///< The key order.
+
+    /**
+     * @brief Get the index of the first key of a node not less than a key; vectorized for arithmetic keys.
+     */
+    std::size_t rank(const Node &node, const T &key) const {
+        return KeySearch<T, Compare>::lower_bound(node.keys(), node.size(), key, less);
+    }
+
+    /**
+     * @brief Descend to the first key at which a node's position function points.
+     *
+     * @param position Callable as position(node), the index of the first key
+     *        at or after the sought position among the node's keys.
+     */
+    template<typename Position>
+    InOrderIterator seek(Position position) const {
+        InOrderIterator it(&root);
+        const Node *node = root;
+        while (node) {
+            std::size_t i = position(*node);
+            it.path.push_back(typename InOrderIterator::Frame{node, i});
+            node = node->leaf ? nullptr : node->child(i);
+        }
+        // At a leaf past its last key, the position is the key above the subtree
+        while (!it.path.empty() && it.path.back().index == it.path.back().node->size()) {
+            it.path.pop_back();
+        }
+        return it;
+    }
+
+    /**
+     * @brief Insert a key into a node that has room for it, at a given index.
+     */
+    static void insert_key(Node &node, std::size_t i, T key) {
+        T *keys = node.slots();
+        std::size_t size = node.size();
+        if (i == size) {
+            new (keys + size) T(std::move(key));
+        } else {
+            new (keys + size) T(std::move(keys[size - 1]));
+            std::move_backward(keys + i, keys + size - 1, keys + size);
+            keys[i] = std::move(key);
+        }
+        node.count = static_cast<std::uint16_t>(size + 1);
+    }
+
+    /**
+     * @brief Split a full child in two around its middle key, which moves up into the parent.
+     *
+     * @param parent A node with room for one more key.
+     * @param i The index of the full child.
+     */
+    static void split_child(Inner &parent, std::size_t i) {
+        Node &full = *parent.children[i];
+        const std::size_t middle = MAX_KEYS / 2;
+        Node *right;
+        if (full.leaf) {
+            right = new Node;
+        } else {
+            Inner *inner = new Inner();
+            Inner &left = static_cast<Inner &>(full);
+            std::copy(left.children + middle + 1, left.children + D, inner->children);
+            std::fill(left.children + middle + 1, left.children + D, nullptr);
+            right = inner;
+        }
+        T *keys = full.slots();
+        std::uninitialized_move(keys + middle + 1, keys + MAX_KEYS, right->slots());
+        right->count = static_cast<std::uint16_t>(MAX_KEYS - middle - 1);
+
+        std::move_backward(parent.children + i + 1, parent.children + parent.size() + 1, parent.children + parent.size() + 2);
+        parent.children[i + 1] = right;
+        insert_key(parent, i, std::move(keys[middle]));
+        std::destroy(keys + middle, keys + MAX_KEYS);
+        full.count = static_cast<std::uint16_t>(middle);
+    }
+
+    /**
+     * @brief Destroy a node's keys and free it, but not its children.
+     */
+    static void destroy(Node *node) {
+        std::destroy(node->slots(), node->slots() + node->size());
+        if (node->leaf)
+            delete node;
+        else
+            delete static_cast<Inner *>(node);
+    }
+};
+
+template<typename T, unsigned int D, typename Compare>
+const typename BTree<T, D, Compare>::Node *BTree<T, D, Compare>::Node::child(std::size_t i) const {
+    return static_cast<const Inner *>(this)->children[i];
+}
+
+#endif // TREESITERATORS_CPP_BTREE_HPP
@@ -0,0 +1,392 @@
+//oriyati0701@gmail.com
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include "BTree.hpp"
+#include "Complex.hpp"
+#include "SearchTree.hpp"
+#include "Tree.hpp"
+#include "TreeTrace.hpp"
+
+/**
+ * @brief Benchmark suite for Tree construction, traversal, heapify and destruction.
+ *
+ * Every benchmark runs for sizes 10^2 up to --max-size, for four tree shapes
+ * (balanced binary, chain, star, random) and five key types (int, double,
+ * std::string, Complex, CachedComplex), and prints one CSV row or JSON object per result.
+ * The time of an operation at the next size is extrapolated from its growth
+ * between the last two sizes; when the prediction exceeds --budget seconds the
+ * operation is reported as skipped for the larger sizes of the same shape and
+ * key type, so quadratic operations do not stall the run.
+ *
+ * Usage: ./benchmark [--max-size N] [--budget SECONDS] [--format csv|json] [--trace FILE]
+ *
+ * With --trace, a build compiled with TREE_ENABLE_TRACING also writes every
+ * build, traversal and heapify span as Chrome trace-event JSON to FILE.
+ */
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+/**
+ * @brief Command line options.
+ */
+struct Options {
+    std::size_t max_size = 1000000;   ///< Largest tree size, a power of ten.
+    double budget = 2.0;              ///< Seconds after which an operation is not run on larger trees.
+    bool json = false;                ///< JSON lines instead of CSV.
+    std::string trace;                ///< Chrome trace output file, empty for none.
+};
+
+/**
+ * @brief One measured operation, in the output format.
+ */
+struct Result {
+    std::string benchmark;   ///< The operation, e.g. "traverse_bfs_scan".
+    std::string shape;       ///< The tree shape.
+    std::string key;         ///< The key type.
+    std::size_t size;        ///< Number of nodes.
+    std::size_t reps;        ///< Number of timed repetitions.
+    double best;             ///< Fastest repetition in seconds.
+    double mean;             ///< Mean repetition in seconds.
+    std::string status;      ///< "ok" or "skipped".
+};
+
+/**
+ * @brief Print a result as a CSV row or a JSON object.
+ *
+ * @param options The output format.
+ * @param result The result to print.
+ */
+void print(const Options &options, const Result &result) {
+    double ns_per_node = result.size ? result.best * 1e9 / static_cast<double>(result.size) : 0;
+    if (options.json) {
+        std::cout << "{\"benchmark\":\"" << result.benchmark << "\",\"shape\":\"" << result.shape
+                  << "\",\"key\":\"" << result.key << "\",\"size\":" << result.size << ",\"reps\":" << result.reps
+                  << ",\"best_seconds\":" << result.best << ",\"mean_seconds\":" << result.mean
+                  << ",\"ns_per_node\":" << ns_per_node << ",\"status\":\"" << result.status << "\"}" << std::endl;
+    } else {
+        std::cout << result.benchmark << ',' << result.shape << ',' << result.key << ',' << result.size << ','
+                  << result.reps << ',' << result.best << ',' << result.mean << ',' << ns_per_node << ','
+                  << result.status << std::endl;
+    }
+}
+
+/**
+ * @brief Make the i-th unique key of a type.
+ */
+template<typename T>
+T make_key(std::size_t i);
+
+template<>
+int make_key<int>(std::size_t i) {
+    return static_cast<int>(i);
+}
+
+template<>
+double make_key<double>(std::size_t i) {
+    return static_cast<double>(i) + 0.5;
+}
+
+template<>
+std::string make_key<std::string>(std::size_t i) {
+    return "node-" + std::to_string(i);
+}
+
+template<>
+Complex make_key<Complex>(std::size_t i) {
+    return Complex(static_cast<double>(i), static_cast<double>(i % 7));
+}
+
+template<>
+CachedComplex make_key<CachedComplex>(std::size_t i) {
+    return CachedComplex(make_key<Complex>(i));
+}
+
+/**
+ * @brief Build the parent index array of a tree shape.
+ *
+ * @param shape "balanced", "chain", "star" or "random".
+ * @param size Number of nodes.
+ * @return std::vector<std::size_t> Parent of every node; node 0 is the root.
+ */
+std::vector<std::size_t> make_parents(const std::string &shape, std::size_t size) {
+    std::vector<std::size_t> parents(size);
+    std::mt19937_64 random(42);
+    for (std::size_t i = 1; i < size; ++i) {
+        if (shape == "balanced")
+            parents[i] = (i - 1) / 2;
+        else if (shape == "chain")
+            parents[i] = i - 1;
+        else if (shape == "star")
+            parents[i] = 0;
+        else
+            parents[i] = std::uniform_int_distribution<std::size_t>(0, i - 1)(random);
+    }
+    if (size > 0)
+        parents[0] = Tree<int>::NO_PARENT;
+    return parents;
+}
+
+/**
+ * @brief Runs and reports the benchmarks of one shape and key type.
+ *
+ * @tparam T The key type.
+ */
+template<typename T>
+class Suite {
+public:
+    /**
+     * @brief Construct a suite.
+     *
+     * @param options The command line options.
+     * @param shape The tree shape.
+     * @param key The name of the key type.
+     */
+    Suite(const Options &options, std::string shape, std::string key)
+        : options(options), shape(std::move(shape)), key(std::move(key)) {}
+
+    /**
+     * @brief Run every benchmark for every size.
+     */
+    void run() {
+        for (std::size_t size = 100; size <= options.max_size; size *= 10) {
+            std::vector<std::size_t> parents = make_parents(shape, size);
+            std::vector<T> keys;
+            for (std::size_t i = 0; i < size; ++i)
+                keys.push_back(make_key<T>(i));
+            run_size(parents, keys);
+        }
+    }
+
+private:
+    const Options &options;
+    std::string shape;
+    std::string key;
+    std::map<std::string, double> last_best;  ///< Fastest repetition of every operation at the previous size.
+    std::vector<std::string> over_budget;     ///< Operations predicted to exceed the budget at the next size.
+    std::size_t tree_size = 0;                ///< Number of nodes of the tree being measured.
+
+    /**
+     * @brief Time an operation, repeating it for small trees.
+     *
+     * @param name The name of the operation.
+     * @param size The number of nodes.
+     * @param setup Untimed preparation before each repetition.
+     * @param operation The timed operation.
+     */
+    void measure(const std::string &name, std::size_t size, const std::function<void()> &setup,
+                 const std::function<void()> &operation) {
+        Result result{name, shape, key, size, 0, 0, 0, "ok"};
+        if (std::find(over_budget.begin(), over_budget.end(), name) != over_budget.end()) {
+            result.status = "skipped";
+            print(options, result);
+            return;
+        }
+        std::size_t reps = std::max<std::size_t>(1, std::min<std::size_t>(20, 100000 / size));
+        double total = 0;
+        result.best = 1e300;
+        for (std::size_t rep = 0; rep < reps; ++rep) {
+            setup();
+            auto start = Clock::now();
+            operation();
+            std::chrono::duration<double> elapsed = Clock::now() - start;
+            total += elapsed.count();
+            result.best = std::min(result.best, elapsed.count());
+            ++result.reps;
+            if (total > options.budget)
+                break;
+        }
+        result.mean = total / static_cast<double>(result.reps);
+        auto previous = last_best.find(name);
+        double growth = previous == last_best.end() ? 10 : std::max(10.0, result.best / previous->second);
+        if (result.best * growth > options.budget)
+            over_budget.push_back(name);
+        last_best[name] = result.best;
+        print(options, result);
+    }
+
+    /**
+     * @brief Report a traversal that missed nodes; reading the count also keeps the loop from being optimized away.
+     */
+    void check_visited(const std::string &name, std::size_t visited) const {
+        if (visited != tree_size)
+            std::cerr << name << ": visited " << visited << " of " << tree_size << " nodes" << std::endl;
+    }
+
+    /**
+     * @brief Time one traversal from its begin_ / end_ pair.
+     */
+    template<typename Begin, typename End>
+    void traverse(const std::string &name, Tree<T> &tree, Begin begin, End end) {
+        measure(name, tree_size, [] {}, [&] {
+            std::size_t visited = 0;
+            for (auto it = (tree.*begin)(); it != (tree.*end)(); ++it) {
+                ++visited;
+            }
+            check_visited(name, visited);
+        });
+    }
+
+    /**
+     * @brief Run all benchmarks on one tree size.
+     */
+    void run_size(const std::vector<std::size_t> &parents, const std::vector<T> &keys) {
+        tree_size = keys.size();
+        std::unique_ptr<Tree<T>> tree;
+        auto reset = [&] { tree.reset(new Tree<T>()); };
+        auto build = [&] {
+            reset();
+            tree->build_from_parent_array(parents, keys);
+        };
+
+        measure("build_add_sub_node", tree_size, reset, [&] {
+            tree->add_root(keys[0]);
+            for (std::size_t i = 1; i < keys.size(); ++i)
+                tree->add_sub_node(keys[parents[i]], keys[i]);
+        });
+        std::vector<typename Tree<T>::Node *> handles(keys.size());
+        measure("build_add_sub_node_ptr", tree_size, reset, [&] {
+            tree->add_root(keys[0]);
+            handles[0] = tree->get_root();
+            for (std::size_t i = 1; i < keys.size(); ++i)
+                handles[i] = tree->add_sub_node(handles[parents[i]], keys[i]);
+        });
+        measure("build_from_parent_array", tree_size, reset, [&] {
+            tree->build_from_parent_array(parents, keys);
+        });
+        SearchTree<T> search;
+        measure("search_tree_insert", tree_size, [&] { search = SearchTree<T>(); }, [&] {
+            for (const T &key : keys)
+                search.insert(key);
+        });
+        measure("search_tree_find", tree_size, [] {}, [&] {
+            std::size_t found = 0;
+            for (const T &key : keys) {
+                if (search.contains(key))
+                    ++found;
+            }
+            if (found != search.size())  // also keeps the lookups from being optimized away
+                std::cerr << "search_tree_find: lost keys" << std::endl;
+        });
+        BTree<T> btree;
+        measure("btree_insert", tree_size, [&] { btree.clear(); }, [&] {
+            for (const T &key : keys)
+                btree.insert(key);
+        });
+        measure("btree_find", tree_size, [] {}, [&] {
+            std::size_t found = 0;
+            for (const T &key : keys) {
+                if (btree.contains(key))
+                    ++found;
+            }
+            if (found != btree.size())
+                std::cerr << "btree_find: lost keys" << std::endl;
+        });
+
+        build();
+        traverse("traverse_pre_order", *tree, &Tree<T>::begin_pre_order, &Tree<T>::end_pre_order);
+        traverse("traverse_post_order", *tree, &Tree<T>::begin_post_order, &Tree<T>::end_post_order);
+        traverse("traverse_in_order", *tree, &Tree<T>::begin_in_order, &Tree<T>::end_in_order);
+        traverse("traverse_bfs_scan", *tree, &Tree<T>::begin_bfs_scan, &Tree<T>::end_bfs_scan);
+        traverse("traverse_dfs_scan", *tree, &Tree<T>::begin_dfs_scan, &Tree<T>::end_dfs_scan);
+        traverse("traverse_reverse_pre_order", *tree, &Tree<T>::begin_reverse_pre_order,
+                 &Tree<T>::end_reverse_pre_order);
+        traverse("traverse_reverse_bfs_scan", *tree, &Tree<T>::begin_reverse_bfs_scan, &Tree<T>::end_reverse_bfs_scan);
+        measure("visit_pre_order", tree_size, [] {}, [&] {
+            std::size_t visited = 0;
+            tree->template visit<PreOrder>([&visited](const typename Tree<T>::Node &) { ++visited; });
+            check_visited("visit_pre_order", visited);
+        });
+        measure("traverse_levels", tree_size, [] {}, [&] {
+            std::size_t visited = 0;
+            for (auto it = tree->begin_levels(); it != tree->end_levels(); ++it) {
+                visited += (*it).size();
+            }
+            check_visited("traverse_levels", visited);
+        });
+#ifdef TREE_HAS_COROUTINES
+        measure("generate_post_order", tree_size, [] {}, [&] {
+            std::size_t visited = 0;
+            for (const auto &node : tree->template generate<PostOrder>()) {
+                if (node)
+                    ++visited;
+            }
+            check_visited("generate_post_order", visited);
+        });
+#endif
+        measure("traverse_heap", tree_size, build, [&] {
+            std::size_t visited = 0;
+            for (auto it = tree->begin_heap(); it != tree->end_heap(); ++it) {
+                ++visited;
+            }
+            check_visited("traverse_heap", visited);
+        });
+        measure("my_heap", tree_size, build, [&] {
+            tree->myHeap();
+        });
+        std::vector<T> shuffled(keys), scratch;
+        std::shuffle(shuffled.begin(), shuffled.end(), std::mt19937_64(7));
+        measure("make_min_heap", tree_size, [&] { scratch = shuffled; }, [&] {
+            make_min_heap(scratch);
+        });
+        measure("sort_by_key", tree_size, [&] { scratch = shuffled; }, [&] {
+            sort_by_key(scratch);
+        });
+        measure("destroy", tree_size, build, [&] {
+            tree.reset();
+        });
+    }
+};
+
+/**
+ * @brief Parse the command line.
+ */
+Options parse_options(int argc, char **argv) {
+    Options options;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (std::strcmp(argv[i], "--max-size") == 0)
+            options.max_size = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (std::strcmp(argv[i], "--budget") == 0)
+            options.budget = std::strtod(argv[i + 1], nullptr);
+        else if (std::strcmp(argv[i], "--format") == 0)
+            options.json = std::strcmp(argv[i + 1], "json") == 0;
+        else if (std::strcmp(argv[i], "--trace") == 0)
+            options.trace = argv[i + 1];
+        else
+            std::cerr << "Unknown option " << argv[i] << std::endl;
+    }
+    return options;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    Options options = parse_options(argc, argv);
+    std::unique_ptr<ChromeTraceWriter> trace;
+    if (!options.trace.empty()) {
+        trace.reset(new ChromeTraceWriter(options.trace));
+        set_trace_sink(trace.get());
+    }
+    if (!options.json)
+        std::cout << "benchmark,shape,key,size,reps,best_seconds,mean_seconds,ns_per_node,status" << std::endl;
+    for (const char *shape : {"balanced", "chain", "star", "random"}) {
+        Suite<int>(options, shape, "int").run();
+        Suite<double>(options, shape, "double").run();
+        Suite<std::string>(options, shape, "string").run();
+        Suite<Complex>(options, shape, "Complex").run();
+        Suite<CachedComplex>(options, shape, "CachedComplex").run();
+    }
+    set_trace_sink(nullptr);
+    return 0;
+}
@@ -1,29 +1,63 @@
 //oriyati0701@gmail.com
+#ifndef TREESITERATORS_CPP_COMPLEX_HPP
+#define TREESITERATORS_CPP_COMPLEX_HPP
+
 #include <iostream>
 #include <string>
+#include <string_view>
+#include <charconv>  // For std::to_chars
+#include <cmath>  // For std::sqrt, std::atan2, std::signbit
+#include <complex>
+#include <cstddef>
+#include <functional>  // For std::hash
+#include <type_traits>
+#include "SortKey.hpp"
 
 /**
  * @brief A class representing complex numbers and supporting basic operations.
+ *
+ * Trivially copyable, so trees of Complex keys can be saved with memcpy
+ * (see TreeBinary.hpp). Everything except abs, arg and the text
+ * conversions is constexpr and noexcept, so keys can be built and combined
+ * at compile time. A double converts implicitly to a Complex with no
+ * imaginary part, as with std::complex; conversions to and from
+ * std::complex<double> are explicit.
  */
 class Complex {
 public:
     double real;       ///< The real part of the complex number.
     double imaginary;  ///< The imaginary part of the complex number.
 
+    static constexpr std::size_t MAX_CHARS = 52;  ///< The longest text of toChars: two 24-character doubles, " - " and "i".
+
     /**
      * @brief Construct a new Complex object.
      *
      * @param real The real part of the complex number.
      * @param imaginary The imaginary part of the complex number.
      */
-    Complex(double real, double imaginary) : real(real), imaginary(imaginary) {}
+    constexpr Complex(double real = 0, double imaginary = 0) noexcept : real(real), imaginary(imaginary) {}
+
+    /**
+     * @brief Construct from a std::complex<double>.
+     *
+     * @param value The complex number.
+     */
+    constexpr explicit Complex(const std::complex<double>& value) noexcept : real(value.real()), imaginary(value.imag()) {}
+
+    /**
+     * @brief Convert to a std::complex<double>.
+     */
+    constexpr explicit operator std::complex<double>() const noexcept {
+        return std::complex<double>(real, imaginary);
+    }
 
     /**
      * @brief Get the real part of the complex number.
      *
      * @return double The real part of the complex number.
      */
-    double getReal() const {
+    constexpr double getReal() const noexcept {
         return real;
     }
 
@@ -32,29 +66,185 @@ public:
      *
      * @return double The imaginary part of the complex number.
      */
-    double getImaginary() const {
+    constexpr double getImaginary() const noexcept {
         return imaginary;
     }
 
+    /**
+     * @brief Get the squared magnitude, the quantity the ordering operators compare.
+     *
+     * @return double real * real + imaginary * imaginary.
+     */
+    constexpr double norm() const noexcept {
+        return real * real + imaginary * imaginary;
+    }
+
+    /**
+     * @brief Get the magnitude.
+     *
+     * @return double The distance from zero, sqrt(norm()).
+     */
+    double abs() const noexcept {
+        return std::sqrt(norm());
+    }
+
+    /**
+     * @brief Get the phase angle.
+     *
+     * @return double The angle from the positive real axis, in radians in [-pi, pi].
+     */
+    double arg() const noexcept {
+        return std::atan2(imaginary, real);
+    }
+
+    /**
+     * @brief Get the complex conjugate.
+     *
+     * @return Complex The number with the imaginary part negated.
+     */
+    constexpr Complex conjugate() const noexcept {
+        return Complex(real, -imaginary);
+    }
+
+    /**
+     * @brief Negation operator.
+     *
+     * @return Complex The number with both parts negated.
+     */
+    constexpr Complex operator-() const noexcept {
+        return Complex(-real, -imaginary);
+    }
+
+    /**
+     * @brief Add another complex number to this one.
+     *
+     * @param other The complex number to add.
+     * @return Complex& This complex number.
+     */
+    constexpr Complex& operator+=(const Complex& other) noexcept {
+        real += other.real;
+        imaginary += other.imaginary;
+        return *this;
+    }
+
+    /**
+     * @brief Subtract another complex number from this one.
+     *
+     * @param other The complex number to subtract.
+     * @return Complex& This complex number.
+     */
+    constexpr Complex& operator-=(const Complex& other) noexcept {
+        real -= other.real;
+        imaginary -= other.imaginary;
+        return *this;
+    }
+
+    /**
+     * @brief Multiply this complex number by another one.
+     *
+     * @param other The factor.
+     * @return Complex& This complex number.
+     */
+    constexpr Complex& operator*=(const Complex& other) noexcept {
+        double product = real * other.real - imaginary * other.imaginary;
+        imaginary = real * other.imaginary + imaginary * other.real;
+        real = product;
+        return *this;
+    }
+
+    /**
+     * @brief Divide this complex number by another one.
+     *
+     * Uses the textbook formula without rescaling, so parts beyond about
+     * 1e154 overflow where std::complex would not; dividing by zero gives
+     * infinities or NaN, like double division.
+     *
+     * @param other The divisor.
+     * @return Complex& This complex number.
+     */
+    constexpr Complex& operator/=(const Complex& other) noexcept {
+        double scale = other.norm();
+        double quotient = (real * other.real + imaginary * other.imaginary) / scale;
+        imaginary = (imaginary * other.real - real * other.imaginary) / scale;
+        real = quotient;
+        return *this;
+    }
+
+    /**
+     * @brief Addition operator; either operand may be a double.
+     */
+    friend constexpr Complex operator+(Complex left, const Complex& right) noexcept {
+        return left += right;
+    }
+
+    /**
+     * @brief Subtraction operator; either operand may be a double.
+     */
+    friend constexpr Complex operator-(Complex left, const Complex& right) noexcept {
+        return left -= right;
+    }
+
+    /**
+     * @brief Multiplication operator; either operand may be a double.
+     */
+    friend constexpr Complex operator*(Complex left, const Complex& right) noexcept {
+        return left *= right;
+    }
+
+    /**
+     * @brief Division operator; either operand may be a double.
+     */
+    friend constexpr Complex operator/(Complex left, const Complex& right) noexcept {
+        return left /= right;
+    }
+
+    /**
+     * @brief Format the complex number as "a + bi" or "a - bi" into a buffer, without allocating.
+     *
+     * Both parts are written with std::to_chars in the shortest form that
+     * reads back to the same double, e.g. "1.5 - 2i"; fromString parses it.
+     *
+     * @param first The start of the buffer.
+     * @param last The end of the buffer; MAX_CHARS bytes always suffice.
+     * @return char* One past the last character written, or nullptr if the buffer is too small.
+     */
+    char* toChars(char* first, char* last) const noexcept {
+        std::to_chars_result written = std::to_chars(first, last, real);
+        if (written.ec != std::errc() || last - written.ptr < 3)
+            return nullptr;
+        char* at = written.ptr;
+        *at++ = ' ';
+        *at++ = std::signbit(imaginary) ? '-' : '+';
+        *at++ = ' ';
+        written = std::to_chars(at, last, std::signbit(imaginary) ? -imaginary : imaginary);
+        if (written.ec != std::errc() || written.ptr == last)
+            return nullptr;
+        *written.ptr = 'i';
+        return written.ptr + 1;
+    }
+
     /**
      * @brief Convert the complex number to a string representation.
      *
-     * @return std::string The string representation of the complex number.
+     * @return std::string The text of toChars, e.g. "1.5 - 2i".
      */
     std::string toString() const {
-        return std::to_string(real) + " + " + std::to_string(imaginary) + "i";
+        char buffer[MAX_CHARS];
+        return std::string(buffer, toChars(buffer, buffer + MAX_CHARS));
     }
 
     /**
      * @brief Output stream operator for printing the complex number.
      *
+     * Formats on the stack, so printing allocates nothing.
+     *
      * @param os The output stream.
      * @param c The complex number to print.
      * @return std::ostream& The output stream.
      */
     friend std::ostream& operator<<(std::ostream& os, const Complex& c) {
-        os << c.toString();
-        return os;
+        char buffer[MAX_CHARS];
+        return os << std::string_view(buffer, static_cast<std::size_t>(c.toChars(buffer, buffer + MAX_CHARS) - buffer));
     }
 
     /**
@@ -64,7 +254,7 @@ public:
      * @return true If the two complex numbers are equal.
      * @return false If the two complex numbers are not equal.
      */
-    bool operator==(const Complex& other) const {
+    constexpr bool operator==(const Complex& other) const noexcept {
         return real == other.real && imaginary == other.imaginary;
     }
 
@@ -75,7 +265,7 @@ public:
      * @return true If the two complex numbers are not equal.
      * @return false If the two complex numbers are equal.
      */
-    bool operator!=(const Complex& other) const {
+    constexpr bool operator!=(const Complex& other) const noexcept {
         return !(*this == other);
     }
 
@@ -86,10 +276,8 @@ public:
      * @return true If this complex number has a smaller magnitude than the other.
      * @return false If this complex number does not have a smaller magnitude than the other.
      */
-    bool operator<(const Complex& other) const {
-        double norm = real * real + imaginary * imaginary;
-        double otherNorm = other.real * other.real + other.imaginary * other.imaginary;
-        return norm < otherNorm;
+    constexpr bool operator<(const Complex& other) const noexcept {
+        return norm() < other.norm();
     }
 
     /**
@@ -99,7 +287,7 @@ public:
      * @return true If this complex number has a greater magnitude than the other.
      * @return false If this complex number does not have a greater magnitude than the other.
      */
-    bool operator>(const Complex& other) const {
+    constexpr bool operator>(const Complex& other) const noexcept {
         return other < *this;
     }
 
@@ -110,7 +298,7 @@ public:
      * @return true If this complex number has a smaller or equal magnitude than the other.
      * @return false If this complex number does not have a smaller or equal magnitude than the other.
      */
-    bool operator<=(const Complex& other) const {
+    constexpr bool operator<=(const Complex& other) const noexcept {
         return !(*this > other);
     }
 
@@ -121,8 +309,251 @@ public:
      * @return true If this complex number has a greater or equal magnitude than the other.
      * @return false If this complex number does not have a greater or equal magnitude than the other.
      */
-    bool operator>=(const Complex& other) const {
+    constexpr bool operator>=(const Complex& other) const noexcept {
         return !(*this < other);
     }
 
 };
+
+static_assert(std::is_trivially_copyable<Complex>::value, "Complex keys are saved with memcpy.");
+
+/**
+ * @brief A complex number that stores its squared magnitude next to its parts.
+ *
+ * Every constructor and setter recomputes the norm, so the ordering
+ * operators are a single double comparison instead of four multiplications.
+ * Meant for comparison-heavy keys, e.g. in heaps and search trees; a value
+ * takes 24 bytes instead of 16. The parts are private to keep the norm in
+ * sync; convert to and from Complex explicitly.
+ */
+class CachedComplex {
+public:
+    /**
+     * @brief Construct a new CachedComplex object.
+     *
+     * @param real The real part of the complex number.
+     * @param imaginary The imaginary part of the complex number.
+     */
+    CachedComplex(double real, double imaginary) : real(real), imaginary(imaginary), cachedNorm(real * real + imaginary * imaginary) {}
+
+    /**
+     * @brief Construct from a Complex, computing its norm once.
+     *
+     * @param value The complex number.
+     */
+    explicit CachedComplex(const Complex& value) : CachedComplex(value.real, value.imaginary) {}
+
+    /**
+     * @brief Get the real part of the complex number.
+     */
+    double getReal() const {
+        return real;
+    }
+
+    /**
+     * @brief Get the imaginary part of the complex number.
+     */
+    double getImaginary() const {
+        return imaginary;
+    }
+
+    /**
+     * @brief Get the cached squared magnitude.
+     */
+    double norm() const {
+        return cachedNorm;
+    }
+
+    /**
+     * @brief Set the real part and update the norm.
+     *
+     * @param value The new real part.
+     */
+    void setReal(double value) {
+        real = value;
+        cachedNorm = real * real + imaginary * imaginary;
+    }
+
+    /**
+     * @brief Set the imaginary part and update the norm.
+     *
+     * @param value The new imaginary part.
+     */
+    void setImaginary(double value) {
+        imaginary = value;
+        cachedNorm = real * real + imaginary * imaginary;
+    }
+
+    /**
+     * @brief Convert to a plain Complex.
+     */
+    Complex toComplex() const {
+        return Complex(real, imaginary);
+    }
+
+    /**
+     * @brief Convert the complex number to a string representation, the same as Complex's.
+     */
+    std::string toString() const {
+        return toComplex().toString();
+    }
+
+    /**
+     * @brief Output stream operator for printing the complex number.
+     *
+     * @param os The output stream.
+     * @param c The complex number to print.
+     * @return std::ostream& The output stream.
+     */
+    friend std::ostream& operator<<(std::ostream& os, const CachedComplex& c) {
+        return os << c.toComplex();
+    }
+
+    /**
+     * @brief Equality operator; compares the parts, like Complex.
+     *
+     * @param other The other complex number to compare with.
+     * @return true If the two complex numbers are equal.
+     */
+    bool operator==(const CachedComplex& other) const {
+        return real == other.real && imaginary == other.imaginary;
+    }
+
+    /**
+     * @brief Inequality operator.
+     *
+     * @param other The other complex number to compare with.
+     * @return true If the two complex numbers are not equal.
+     */
+    bool operator!=(const CachedComplex& other) const {
+        return !(*this == other);
+    }
+
+    /**
+     * @brief Less-than operator: the magnitude ordering of Complex, from the cached norms.
+     *
+     * @param other The other complex number to compare with.
+     * @return true If this complex number has a smaller magnitude than the other.
+     */
+    bool operator<(const CachedComplex& other) const {
+        return cachedNorm < other.cachedNorm;
+    }
+
+    /**
+     * @brief Greater-than operator, from the cached norms.
+     *
+     * @param other The other complex number to compare with.
+     * @return true If this complex number has a greater magnitude than the other.
+     */
+    bool operator>(const CachedComplex& other) const {
+        return other.cachedNorm < cachedNorm;
+    }
+
+    /**
+     * @brief Less-than-or-equal-to operator, from the cached norms.
+     *
+     * @param other The other complex number to compare with.
+     * @return true If this complex number has a smaller or equal magnitude than the other.
+     */
+    bool operator<=(const CachedComplex& other) const {
+        return !(other.cachedNorm < cachedNorm);
+    }
+
+    /**
+     * @brief Greater-than-or-equal-to operator, from the cached norms.
+     *
+     * @param other The other complex number to compare with.
+     * @return true If this complex number has a greater or equal magnitude than the other.
+     */
+    bool operator>=(const CachedComplex& other) const {
+        return !(cachedNorm < other.cachedNorm);
+    }
+
+private:
+    double real;        ///< The real part of the complex number.
+    double imaginary;   ///< The imaginary part of the complex number.
+    double cachedNorm;  ///< real * real + imaginary * imaginary, kept in sync by every mutator.
+};
+
+/**
+ * @brief Complex values sort by their squared magnitude, computed for a whole array at once.
+ *
+ * The parts are stored interleaved; two values at a time are transposed
+ * into a vector of real parts and one of imaginary parts, so one multiply
+ * and add yields two norms.
+ */
+template<>
+struct SortKey<Complex> {
+    static constexpr bool ENABLED = true;
+    using Type = double;
+
+    /**
+     * @brief Write the squared magnitude of every value.
+     *
+     * @param values The values.
+     * @param count The number of values.
+     * @param norms Room for count norms.
+     */
+    static void compute(const Complex *values, std::size_t count, double *norms) {
+        std::size_t i = 0;
+#ifdef TREE_HAS_SSE2
+        static_assert(sizeof(Complex) == 2 * sizeof(double), "The parts of a Complex must be adjacent.");
+        for (; i + 2 <= count; i += 2) {
+            __m128d first = _mm_loadu_pd(&values[i].real);        // real, imaginary of values[i]
+            __m128d second = _mm_loadu_pd(&values[i + 1].real);   // and of values[i + 1]
+            __m128d reals = _mm_unpacklo_pd(first, second);
+            __m128d imaginaries = _mm_unpackhi_pd(first, second);
+            _mm_storeu_pd(norms + i, _mm_add_pd(_mm_mul_pd(reals, reals), _mm_mul_pd(imaginaries, imaginaries)));
+        }
+#endif
+        for (; i < count; ++i) {
+            norms[i] = values[i].norm();
+        }
+    }
+};
+
+/**
+ * @brief CachedComplex values already hold their sort key.
+ */
+template<>
+struct SortKey<CachedComplex> {
+    static constexpr bool ENABLED = true;
+    using Type = double;
+
+    static void compute(const CachedComplex *values, std::size_t count, double *norms) {
+        for (std::size_t i = 0; i < count; ++i) {
+            norms[i] = values[i].norm();
+        }
+    }
+};
+
+namespace std {
+    /**
+     * @brief Hash specialization so Complex keys can be looked up in unordered containers.
+     */
+    template<>
+    struct hash<Complex> {
+        /**
+         * @brief Combine the hashes of the real and imaginary parts.
+         *
+         * @param c The complex number to hash.
+         * @return size_t The hash value.
+         */
+        size_t operator()(const Complex& c) const {
+            size_t seed = hash<double>()(c.real);
+            return seed ^ (hash<double>()(c.imaginary) + 0x9e3779b9 + (seed << 6) + (seed >> 2));
+        }
+    };
+
+    /**
+     * @brief CachedComplex hashes like the equal Complex.
+     */
+    template<>
+    struct hash<CachedComplex> {
+        size_t operator()(const CachedComplex& c) const {
+            return hash<Complex>()(c.toComplex());
+        }
+    };
+}
+
+#endif // TREESITERATORS_CPP_COMPLEX_HPP
@@ -0,0 +1,91 @@
+//oriyati0701@gmail.com
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Tree.hpp"
+
+/**
+ * @brief Scalability benchmark for concurrent add_sub_node on wide trees.
+ *
+ * The root gets WIDTH children; thread t only inserts under the branches whose
+ * index is t modulo the thread count, so all writers work on disjoint subtrees.
+ * Every run performs the same total number of inserts (strong scaling) and is
+ * repeated with one external mutex around each insert to show what a global
+ * tree lock would cost.
+ *
+ * Usage: ./bench_concurrency [total_inserts]
+ */
+
+namespace {
+
+const unsigned int WIDTH = 1024;  ///< Number of root children, i.e. independent subtrees.
+
+/**
+ * @brief Insert into a fresh wide tree from several threads and time it.
+ *
+ * @param threads Number of writer threads.
+ * @param total Total number of inserts, split evenly between the threads.
+ * @param global_lock Whether every insert is serialized through one mutex.
+ * @return double Elapsed wall-clock seconds.
+ */
+double run(unsigned int threads, unsigned int total, bool global_lock) {
+    Tree<int, WIDTH> tree;
+    tree.add_root(0);
+    std::vector<Tree<int, WIDTH>::Node *> branches;
+    for (unsigned int i = 0; i < WIDTH; ++i) {
+        branches.push_back(tree.add_sub_node(tree.get_root(), static_cast<int>(i + 1)));
+    }
+
+    std::mutex global;
+    unsigned int per_thread = total / threads;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (unsigned int t = 0; t < threads; ++t) {
+        workers.emplace_back([&, t]() {
+            unsigned int branch = t;
+            for (unsigned int i = 0; i < per_thread; ++i) {
+                if (global_lock) {
+                    std::lock_guard<std::mutex> guard(global);
+                    tree.add_sub_node(branches[branch], static_cast<int>(i));
+                } else {
+                    tree.add_sub_node(branches[branch], static_cast<int>(i));
+                }
+                branch += threads;
+                if (branch >= WIDTH)
+                    branch = t;
+            }
+        });
+    }
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    unsigned int total = argc > 1 ? static_cast<unsigned int>(std::strtoul(argv[1], nullptr, 10)) : 4000000;
+
+    std::cout << "threads,inserts,striped_seconds,striped_inserts_per_sec,global_seconds,global_inserts_per_sec,speedup"
+              << std::endl;
+    double baseline = 0;
+    for (unsigned int threads = 1; threads <= 32; threads *= 2) {
+        unsigned int inserts = total / threads * threads;
+        double striped = run(threads, inserts, false);
+        double global = run(threads, inserts, true);
+        if (threads == 1)
+            baseline = striped;
+        std::cout << threads << ',' << inserts << ','
+                  << std::fixed << std::setprecision(4) << striped << ',' << std::setprecision(0) << inserts / striped << ','
+                  << std::setprecision(4) << global << ',' << std::setprecision(0) << inserts / global << ','
+                  << std::setprecision(2) << baseline / striped << std::endl;
+    }
+    return 0;
+}
@@ -6,6 +6,7 @@
 #include <SFML/Graphics.hpp>
 #include <typeinfo>  // For typeid
 #include <string>  // For std::to_string
+#include <vector>
 #include "Complex.hpp"  // For std::complex
 #include "Tree.hpp"  // Include your tree structure header here
 
@@ -19,6 +20,11 @@ inline std::string toString(Complex value) {
     return value.toString();
 }
 
+template<>
+inline std::string toString(CachedComplex value) {
+    return value.toString();
+}
+
 template<>
 inline std::string toString(std::string value) {
     return value;
@@ -34,6 +40,7 @@ private:
     sf::Font font;  // Example font for text rendering
     sf::CircleShape nodeShape;  // Example node shape for visualization
     sf::Text nodeText;  // Example text for node labels
+    std::size_t drawnNodes = 0;  // Nodes drawn in the current frame, reported with its trace span
 
 public:
     GUI(Tree<T,D> t) : window(sf::VideoMode(1600, 1200), "Tree GUI"), tree(t) {
@@ -57,6 +64,8 @@ public:
 
     void run() {
         while (window.isOpen()) {
+            TraceSpan span("gui_frame");
+            drawnNodes = 0;
             sf::Event event;
             while (window.pollEvent(event)) {
                 if (event.type == sf::Event::Closed)
@@ -66,37 +75,56 @@ public:
             window.clear(sf::Color::White);
 
             // Example: Draw the tree nodes
-             drawTree(tree.get_root(), 1200, 50, 600); // Assuming a method to draw nodes
+             drawTree(1200, 50, 600); // Assuming a method to draw nodes
 
             window.display();
+            span.set_nodes(drawnNodes);
         }
     }
 
-    // Example method to draw tree nodes recursively
-    void drawTree(typename Tree<T,D>::Node* node, float x, float y, float xOffset) {
-        if (node) {
-            // Draw current node
-            nodeShape.setPosition(x, y);
-            window.draw(nodeShape);
-
-            nodeText.setString(toString(node->key));
-            nodeText.setPosition(x, y + 60);
-            nodeText.setFillColor(sf::Color::Magenta);  // Example text color (white
-            window.draw(nodeText);
-
-            // Recursively draw children nodes
-            float nextLevelY = y + 300;
-            float nextLevelXOffset = xOffset / D;
-            for (size_t i = 0; i < node->children.size(); ++i) {
-                sf::VertexArray line(sf::Lines, 5);
-                line[0].position = sf::Vector2f(x + nodeShape.getRadius(), y + nodeShape.getRadius());
-                line[1].position = sf::Vector2f(x - xOffset/2 + i * nextLevelXOffset + nodeShape.getRadius(), nextLevelY + nodeShape.getRadius());
-                line[0].color = sf::Color::Red;
-                line[1].color = sf::Color::Blue;
-                window.draw(line);
-
-                drawTree(node->children[i].get(), x - xOffset/2 + i * nextLevelXOffset, nextLevelY, nextLevelXOffset);
+    // Draw the tree level by level; the children of each level are the next level, in order,
+    // so positions are carried over in an array instead of on the call stack
+    void drawTree(float x, float y, float xOffset) {
+        std::vector<sf::Vector2f> positions{sf::Vector2f(x, y)};  // Of the nodes on the current level
+        std::vector<float> offsets{xOffset};
+        std::vector<sf::Vector2f> nextPositions;
+        std::vector<float> nextOffsets;
+        for (const auto &level : tree.levels()) {
+            nextPositions.clear();
+            nextOffsets.clear();
+            for (std::size_t j = 0; j < level.size(); ++j) {
+                typename Tree<T,D>::Node *node = level[j];
+                float nodeX = positions[j].x;
+                float nodeY = positions[j].y;
+
+                // Draw current node
+                nodeShape.setPosition(nodeX, nodeY);
+                window.draw(nodeShape);
+                ++drawnNodes;
+
+                nodeText.setString(toString(node->key));
+                nodeText.setPosition(nodeX, nodeY + 60);
+                nodeText.setFillColor(sf::Color::Magenta);  // Example text color (white
+                window.draw(nodeText);
+
+                // Connect the children and place them on the next level
+                float nextLevelY = nodeY + 300;
+                float nextLevelXOffset = offsets[j] / D;
+                for (size_t i = 0; i < node->children.size(); ++i) {
+                    float childX = nodeX - offsets[j]/2 + i * nextLevelXOffset;
+                    sf::VertexArray line(sf::Lines, 5);
+                    line[0].position = sf::Vector2f(nodeX + nodeShape.getRadius(), nodeY + nodeShape.getRadius());
+                    line[1].position = sf::Vector2f(childX + nodeShape.getRadius(), nextLevelY + nodeShape.getRadius());
+                    line[0].color = sf::Color::Red;
+                    line[1].color = sf::Color::Blue;
+                    window.draw(line);
+
+                    nextPositions.emplace_back(childX, nextLevelY);
+                    nextOffsets.push_back(nextLevelXOffset);
+                }
             }
+            positions.swap(nextPositions);
+            offsets.swap(nextOffsets);
         }
     }
 
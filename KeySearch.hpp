@@ -0,0 +1,294 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_KEYSEARCH_HPP
+#define TREESITERATORS_CPP_KEYSEARCH_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>  // For std::less
+#include <type_traits>
+
+// Compile with -DTREE_DISABLE_SIMD to search every key type with the scalar fallback.
+#if !defined(TREE_DISABLE_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define TREE_HAS_SSE2 1
+#include <emmintrin.h>
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#endif
+#if defined(__AVX2__)
+#define TREE_HAS_AVX2 1
+#include <immintrin.h>
+#endif
+#endif
+
+/**
+ * @brief Counts the keys of a contiguous array that are less than, or greater than, a key with vector comparisons.
+ *
+ * Specialized when SSE2 is available for 32- and 64-bit integers, float
+ * and double (64-bit integers need SSE4.2). AVX2 doubles the width when
+ * the build targets it, e.g. with -march=native. The primary template is
+ * disabled, and KeySearch then falls back to a binary search with the
+ * tree's comparator, as for std::string or Complex keys.
+ *
+ * @tparam T The key type.
+ */
+template<typename T, typename = void>
+struct SimdKeys {
+    static constexpr bool ENABLED = false;
+};
+
+#ifdef TREE_HAS_SSE2
+/**
+ * @brief Add up the 32-bit lanes of a vector of counts.
+ */
+inline std::size_t simd_sum32(__m128i counts) {
+    std::int32_t lanes[4];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), counts);
+    return static_cast<std::size_t>(lanes[0]) + static_cast<std::size_t>(lanes[1]) +
+           static_cast<std::size_t>(lanes[2]) + static_cast<std::size_t>(lanes[3]);
+}
+
+/**
+ * @brief Add up the 64-bit lanes of a vector of counts.
+ */
+inline std::size_t simd_sum64(__m128i counts) {
+    std::int64_t lanes[2];
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(lanes), counts);
+    return static_cast<std::size_t>(lanes[0]) + static_cast<std::size_t>(lanes[1]);
+}
+
+#ifdef TREE_HAS_AVX2
+inline std::size_t simd_sum32(__m256i counts) {
+    return simd_sum32(_mm256_castsi256_si128(counts)) + simd_sum32(_mm256_extracti128_si256(counts, 1));
+}
+
+inline std::size_t simd_sum64(__m256i counts) {
+    return simd_sum64(_mm256_castsi256_si128(counts)) + simd_sum64(_mm256_extracti128_si256(counts, 1));
+}
+#endif
+
+/**
+ * @brief 32-bit integers; unsigned keys are offset by 2^31 so that the signed comparison orders them.
+ */
+template<typename T>
+struct SimdKeys<T, std::enable_if_t<std::is_integral<T>::value && sizeof(T) == 4>> {
+    static constexpr bool ENABLED = true;
+
+    /**
+     * @brief Count the keys less than a key, or greater than it if Greater is true.
+     */
+    template<bool Greater>
+    static std::size_t count(const T *keys, std::size_t size, T key) {
+        const std::int32_t bias = std::is_signed<T>::value ? 0 : INT32_MIN;
+        std::int32_t needle;
+        std::memcpy(&needle, &key, sizeof(needle));
+        std::size_t i = 0, total = 0;
+#ifdef TREE_HAS_AVX2
+        const __m256i bias8 = _mm256_set1_epi32(bias);
+        const __m256i needle8 = _mm256_xor_si256(_mm256_set1_epi32(needle), bias8);
+        __m256i counts8 = _mm256_setzero_si256();
+        for (; i + 8 <= size; i += 8) {
+            __m256i lanes = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), bias8);
+            counts8 = _mm256_sub_epi32(counts8, Greater ? _mm256_cmpgt_epi32(lanes, needle8) : _mm256_cmpgt_epi32(needle8, lanes));
+        }
+        total += simd_sum32(counts8);
+#endif
+        const __m128i bias4 = _mm_set1_epi32(bias);
+        const __m128i needle4 = _mm_xor_si128(_mm_set1_epi32(needle), bias4);
+        __m128i counts4 = _mm_setzero_si128();
+        for (; i + 4 <= size; i += 4) {
+            __m128i lanes = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)), bias4);
+            counts4 = _mm_sub_epi32(counts4, Greater ? _mm_cmpgt_epi32(lanes, needle4) : _mm_cmpgt_epi32(needle4, lanes));
+        }
+        total += simd_sum32(counts4);
+        for (; i < size; ++i) {
+            total += Greater ? (key < keys[i]) : (keys[i] < key);
+        }
+        return total;
+    }
+};
+
+#ifdef __SSE4_2__
+/**
+ * @brief 64-bit integers, offset like the 32-bit ones; the 64-bit comparison needs SSE4.2.
+ */
+template<typename T>
+struct SimdKeys<T, std::enable_if_t<std::is_integral<T>::value && sizeof(T) == 8>> {
+    static constexpr bool ENABLED = true;
+
+    template<bool Greater>
+    static std::size_t count(const T *keys, std::size_t size, T key) {
+        const std::int64_t bias = std::is_signed<T>::value ? 0 : INT64_MIN;
+        std::int64_t needle;
+        std::memcpy(&needle, &key, sizeof(needle));
+        std::size_t i = 0, total = 0;
+#ifdef TREE_HAS_AVX2
+        const __m256i bias4 = _mm256_set1_epi64x(bias);
+        const __m256i needle4 = _mm256_xor_si256(_mm256_set1_epi64x(needle), bias4);
+        __m256i counts4 = _mm256_setzero_si256();
+        for (; i + 4 <= size; i += 4) {
+            __m256i lanes = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(keys + i)), bias4);
+            counts4 = _mm256_sub_epi64(counts4, Greater ? _mm256_cmpgt_epi64(lanes, needle4) : _mm256_cmpgt_epi64(needle4, lanes));
+        }
+        total += simd_sum64(counts4);
+#endif
+        const __m128i bias2 = _mm_set1_epi64x(bias);
+        const __m128i needle2 = _mm_xor_si128(_mm_set1_epi64x(needle), bias2);
+        __m128i counts2 = _mm_setzero_si128();
+        for (; i + 2 <= size; i += 2) {
+            __m128i lanes = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(keys + i)), bias2);
+            counts2 = _mm_sub_epi64(counts2, Greater ? _mm_cmpgt_epi64(lanes, needle2) : _mm_cmpgt_epi64(needle2, lanes));
+        }
+        total += simd_sum64(counts2);
+        for (; i < size; ++i) {
+            total += Greater ? (key < keys[i]) : (keys[i] < key);
+        }
+        return total;
+    }
+};
+#endif // __SSE4_2__
+
+/**
+ * @brief float keys; a comparison with NaN counts as neither less nor greater, as with operator<.
+ */
+template<>
+struct SimdKeys<float> {
+    static constexpr bool ENABLED = true;
+
+    template<bool Greater>
+    static std::size_t count(const float *keys, std::size_t size, float key) {
+        std::size_t i = 0, total = 0;
+#ifdef TREE_HAS_AVX2
+        const __m256 needle8 = _mm256_set1_ps(key);
+        __m256i counts8 = _mm256_setzero_si256();
+        for (; i + 8 <= size; i += 8) {
+            __m256 lanes = _mm256_loadu_ps(keys + i);
+            __m256 hits = _mm256_cmp_ps(lanes, needle8, Greater ? _CMP_GT_OQ : _CMP_LT_OQ);
+            counts8 = _mm256_sub_epi32(counts8, _mm256_castps_si256(hits));
+        }
+        total += simd_sum32(counts8);
+#endif
+        const __m128 needle4 = _mm_set1_ps(key);
+        __m128i counts4 = _mm_setzero_si128();
+        for (; i + 4 <= size; i += 4) {
+            __m128 lanes = _mm_loadu_ps(keys + i);
+            __m128 hits = Greater ? _mm_cmpgt_ps(lanes, needle4) : _mm_cmplt_ps(lanes, needle4);
+            counts4 = _mm_sub_epi32(counts4, _mm_castps_si128(hits));
+        }
+        total += simd_sum32(counts4);
+        for (; i < size; ++i) {
+            total += Greater ? (key < keys[i]) : (keys[i] < key);
+        }
+        return total;
+    }
+};
+
+/**
+ * @brief double keys, compared like float ones.
+ */
+template<>
+struct SimdKeys<double> {
+    static constexpr bool ENABLED = true;
+
+    template<bool Greater>
+    static std::size_t count(const double *keys, std::size_t size, double key) {
+        std::size_t i = 0, total = 0;
+#ifdef TREE_HAS_AVX2
+        const __m256d needle4 = _mm256_set1_pd(key);
+        __m256i counts4 = _mm256_setzero_si256();
+        for (; i + 4 <= size; i += 4) {
+            __m256d lanes = _mm256_loadu_pd(keys + i);
+            __m256d hits = _mm256_cmp_pd(lanes, needle4, Greater ? _CMP_GT_OQ : _CMP_LT_OQ);
+            counts4 = _mm256_sub_epi64(counts4, _mm256_castpd_si256(hits));
+        }
+        total += simd_sum64(counts4);
+#endif
+        const __m128d needle2 = _mm_set1_pd(key);
+        __m128i counts2 = _mm_setzero_si128();
+        for (; i + 2 <= size; i += 2) {
+            __m128d lanes = _mm_loadu_pd(keys + i);
+            __m128d hits = Greater ? _mm_cmpgt_pd(lanes, needle2) : _mm_cmplt_pd(lanes, needle2);
+            counts2 = _mm_sub_epi64(counts2, _mm_castpd_si128(hits));
+        }
+        total += simd_sum64(counts2);
+        for (; i < size; ++i) {
+            total += Greater ? (key < keys[i]) : (keys[i] < key);
+        }
+        return total;
+    }
+};
+#endif // TREE_HAS_SSE2
+
+/**
+ * @brief Finds the position of a key among the sorted keys of one node.
+ *
+ * The generic version is a binary search with the comparator. With
+ * std::less over a SimdKeys type, a node's keys are instead compared with
+ * the key all at once: in a sorted array, the number of keys less than the
+ * key is its lower bound, so the scan has no data-dependent branch. Arrays
+ * longer than SIMD_WINDOW keys are first narrowed by binary search.
+ *
+ * @tparam T The key type.
+ * @tparam Compare The strict weak order of the keys.
+ */
+template<typename T, typename Compare, typename = void>
+struct KeySearch {
+    static constexpr bool VECTORIZED = false;  ///< Whether the search compares several keys per instruction.
+
+    /**
+     * @brief Get the index of the first key not less than a key.
+     */
+    static std::size_t lower_bound(const T *keys, std::size_t size, const T &key, const Compare &less) {
+        return static_cast<std::size_t>(std::lower_bound(keys, keys + size, key, less) - keys);
+    }
+
+    /**
+     * @brief Get the index of the first key greater than a key.
+     */
+    static std::size_t upper_bound(const T *keys, std::size_t size, const T &key, const Compare &less) {
+        return static_cast<std::size_t>(std::upper_bound(keys, keys + size, key, less) - keys);
+    }
+};
+
+template<typename T>
+struct KeySearch<T, std::less<T>, std::enable_if_t<SimdKeys<T>::ENABLED>> {
+    static constexpr bool VECTORIZED = true;
+    static constexpr std::size_t SIMD_WINDOW = 64;  ///< The most keys compared in one scan.
+
+    static std::size_t lower_bound(const T *keys, std::size_t size, const T &key, const std::less<T> &) {
+        std::size_t first = narrow(keys, size, [&key](const T &probe) { return probe < key; });
+        return first + SimdKeys<T>::template count<false>(keys + first, std::min(size - first, SIMD_WINDOW), key);
+    }
+
+    static std::size_t upper_bound(const T *keys, std::size_t size, const T &key, const std::less<T> &) {
+        std::size_t first = narrow(keys, size, [&key](const T &probe) { return !(key < probe); });
+        std::size_t window = std::min(size - first, SIMD_WINDOW);
+        return first + window - SimdKeys<T>::template count<true>(keys + first, window, key);
+    }
+
+private:
+    /**
+     * @brief Binary search down to a window of at most SIMD_WINDOW keys that holds the position.
+     *
+     * @param before True for the keys before the sought position.
+     * @return std::size_t The first index of the window.
+     */
+    template<typename Before>
+    static std::size_t narrow(const T *keys, std::size_t size, Before before) {
+        std::size_t first = 0;
+        while (size > SIMD_WINDOW) {
+            std::size_t half = size / 2;
+            if (before(keys[first + half])) {
+                first += half + 1;
+                size -= half + 1;
+            } else {
+                size = half;
+            }
+        }
+        return first;
+    }
+};
+
+#endif // TREESITERATORS_CPP_KEYSEARCH_HPP
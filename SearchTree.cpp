@@ -0,0 +1,5 @@
+//
+// //oriyati0701@gmail.com
+//
+
+#include "SearchTree.hpp"
@@ -0,0 +1,464 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_SEARCHTREE_HPP
+#define TREESITERATORS_CPP_SEARCHTREE_HPP
+
+#include <cstddef>
+#include <functional>  // For std::less
+#include <iterator>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "Tree.hpp"
+
+/**
+ * @brief An ordered set of keys kept as a self-balancing binary search tree inside a Tree<T, 2>.
+ *
+ * The nodes are ordinary Tree nodes: a node's children are its left and
+ * right subtrees, smaller key first, so a lone child is a left child if its
+ * key is smaller and a right child otherwise. Iteration, lower_bound and
+ * range() use Tree's bidirectional in-order iterator with a split policy
+ * that tells the two apart.
+ *
+ * Balance follows the scapegoat scheme: an insert that lands deeper than
+ * log_{3/2}(size) rebuilds the smallest unbalanced subtree on its path
+ * into a perfectly balanced one. Nodes need no balance field, the height
+ * stays O(log n), so insert, find and lower_bound take O(log n) (inserts
+ * amortized), against the full breadth-first scan of a value search in a
+ * plain Tree.
+ *
+ * Not safe for concurrent writers.
+ *
+ * @tparam T The key type.
+ * @tparam Compare The strict weak order of the keys; must be default-constructible.
+ */
+template<typename T, typename Compare = std::less<T>>
+class SearchTree {
+public:
+    using Node = typename Tree<T, 2>::Node;
+
+    /**
+     * @brief In-order split of a search tree node: after its left child, if it has one.
+     */
+    struct Split {
+        static constexpr bool MIRRORED = false;
+
+        static std::size_t at(const Node &node) {
+            switch (node.children.size()) {
+                case 0:
+                    return 0;
+                case 1:
+                    return Compare()(node.children[0]->key, node.key) ? 1 : 0;
+                default:
+                    return 1;
+            }
+        }
+    };
+
+    /**
+     * @brief Bidirectional iterator over the keys in order.
+     *
+     * Wraps Tree's in-order iterator but yields the keys as const T &, so a
+     * key cannot be changed in place and break the order of the set.
+     */
+    class Iterator {
+    public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        /**
+         * @brief Construct a detached end iterator.
+         */
+        Iterator() = default;
+
+        reference operator*() const {
+            return (*position)->key;
+        }
+
+        pointer operator->() const {
+            return &(*position)->key;
+        }
+
+        /**
+         * @brief Move to the next key, or to the end after the largest one.
+         */
+        Iterator &operator++() {
+            ++position;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        /**
+         * @brief Move to the previous key; from end(), to the largest key.
+         */
+        Iterator &operator--() {
+            --position;
+            return *this;
+        }
+
+        Iterator operator--(int) {
+            Iterator next = *this;
+            --*this;
+            return next;
+        }
+
+        bool operator==(const Iterator &other) const {
+            return position == other.position;
+        }
+
+        bool operator!=(const Iterator &other) const {
+            return position != other.position;
+        }
+
+    private:
+        friend class SearchTree;
+
+        using Position = typename Tree<T, 2>::template Iterator<InOrderWith<Split>>;
+
+        Position position;  ///< The node of the current key.
+
+        explicit Iterator(Position position) : position(std::move(position)) {}
+    };
+
+    /**
+     * @brief Construct an empty set.
+     */
+    SearchTree() = default;
+
+    /**
+     * @brief Copy a set; the copy owns its own nodes, so inserting into either leaves the other unchanged.
+     */
+    SearchTree(const SearchTree &other)
+        : count(other.count), depth_limit(other.depth_limit), next_limit_at(other.next_limit_at), less(other.less) {
+        tree.root = clone(other.tree.root);
+        tree.counters.allocated(count);
+    }
+
+    /**
+     * @brief Move a set, leaving the source empty but usable.
+     */
+    SearchTree(SearchTree &&other) noexcept
+        : tree(std::move(other.tree)), count(std::exchange(other.count, 0)), depth_limit(std::exchange(other.depth_limit, 0)),
+          next_limit_at(std::exchange(other.next_limit_at, 1)), less(std::move(other.less)) {}
+
+    /**
+     * @brief Copy-assign a set, see the copy constructor.
+     */
+    SearchTree &operator=(const SearchTree &other) {
+        if (this != &other)
+            *this = SearchTree(other);
+        return *this;
+    }
+
+    /**
+     * @brief Move-assign a set, leaving the source empty but usable.
+     */
+    SearchTree &operator=(SearchTree &&other) {
+        if (this != &other) {
+            tree = std::move(other.tree);
+            count = std::exchange(other.count, 0);
+            depth_limit = std::exchange(other.depth_limit, 0);
+            next_limit_at = std::exchange(other.next_limit_at, 1);
+            less = std::move(other.less);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Insert a key, unless an equivalent key is already present.
+     *
+     * @param key The key.
+     * @return true If the key was inserted.
+     * @return false If an equivalent key was already present.
+     */
+    bool insert(const T &key) {
+        if (!tree.root) {
+            tree.root = std::make_shared<Node>(key);
+            tree.counters.allocated(1);
+            grow(1);
+            return true;
+        }
+        path.clear();
+        std::shared_ptr<Node> *slot = &tree.root;
+        while (true) {
+            Node &node = **slot;
+            path.push_back(slot);
+            bool left = less(key, node.key);
+            if (!left && !less(node.key, key))
+                return false;
+            std::shared_ptr<Node> *next = child(node, left);
+            if (!next) {
+                path.push_back(attach(node, std::make_shared<Node>(key), left));
+                break;
+            }
+            slot = next;
+        }
+        tree.counters.allocated(1);
+        grow(count + 1);
+        if (path.size() > depth_limit)
+            rebalance();
+        return true;
+    }
+
+    /**
+     * @brief Check whether an equivalent key is present.
+     *
+     * @param key The key.
+     * @return true If the key is present.
+     */
+    bool contains(const T &key) const {
+        return find_node(key) != nullptr;
+    }
+
+    /**
+     * @brief Find an equivalent key.
+     *
+     * @param key The key.
+     * @return Iterator An iterator at that key, or end() if there is none.
+     */
+    Iterator find(const T &key) const {
+        Iterator it = lower_bound(key);
+        if (it != end() && !less(key, *it))
+            return it;
+        return end();
+    }
+
+    /**
+     * @brief Get an iterator at the first key not less than a key.
+     *
+     * @param key The key.
+     * @return Iterator The iterator, end() if every key is less.
+     */
+    Iterator lower_bound(const T &key) const {
+        return Iterator(tree.template partition_point<Split>([this, &key](const Node &node) { return less(node.key, key); }));
+    }
+
+    /**
+     * @brief Get an iterator at the first key greater than a key.
+     *
+     * @param key The key.
+     * @return Iterator The iterator, end() if no key is greater.
+     */
+    Iterator upper_bound(const T &key) const {
+        return Iterator(tree.template partition_point<Split>([this, &key](const Node &node) { return !less(key, node.key); }));
+    }
+
+    /**
+     * @brief Get the keys in [low, high) as a lazy range in key order.
+     *
+     * @param low The smallest key included.
+     * @param high The first key excluded.
+     * @return TraversalRange<Iterator> The range.
+     */
+    TraversalRange<Iterator> range(const T &low, const T &high) const {
+        return TraversalRange<Iterator>(lower_bound(low), lower_bound(high));
+    }
+
+    /**
+     * @brief Get an iterator at the smallest key.
+     */
+    Iterator begin() const {
+        return Iterator(tree.template in_order<Split>().begin());
+    }
+
+    /**
+     * @brief Get the end iterator, which can be decremented to the largest key.
+     */
+    Iterator end() const {
+        return Iterator(tree.template in_order<Split>().end());
+    }
+
+    /**
+     * @brief Get the number of keys.
+     */
+    std::size_t size() const {
+        return count;
+    }
+
+    /**
+     * @brief Check whether the set has no keys.
+     */
+    bool empty() const {
+        return count == 0;
+    }
+
+    /**
+     * @brief Get the underlying tree, e.g. for its breadth-first traversals or stats.
+     *
+     * @return const Tree<T, 2>& The tree; its default in_order() treats every lone child as a left child.
+     */
+    const Tree<T, 2> &get_tree() const {
+        return tree;
+    }
+
+private:
+    Tree<T, 2> tree;                             ///< Owns the nodes.
+    std::size_t count = 0;                       ///< Number of keys.
+    std::size_t depth_limit = 0;                 ///< floor(log_{3/2}(count)) + 1, the deepest path in nodes.
+    double next_limit_at = 1;                    ///< The count from which depth_limit is one larger: 1.5^depth_limit.
+    std::vector<std::shared_ptr<Node> *> path;   ///< Slots from the root to the last inserted node, reused.
+    std::vector<const Node *> pending;           ///< Scratch stack for counting subtrees.
+    std::vector<std::shared_ptr<Node>> sorted;   ///< Scratch for the nodes of a subtree being rebuilt.
+    std::vector<std::pair<std::shared_ptr<Node> *, std::shared_ptr<Node> *>> spine;  ///< Rebuild walk: slots and their right children.
+    Compare less;                                ///< The key order.
+
+    /**
+     * @brief Get the slot of a node's left or right child.
+     *
+     * @return std::shared_ptr<Node>* The slot, or null if the node has no such child.
+     */
+    std::shared_ptr<Node> *child(Node &node, bool left) {
+        std::size_t split = Split::at(node);
+        if (left)
+            return split > 0 ? &node.children[0] : nullptr;
+        return split < node.children.size() ? &node.children.back() : nullptr;
+    }
+
+    /**
+     * @brief Give a node a new left or right child, keeping the smaller child first.
+     *
+     * @return std::shared_ptr<Node>* The slot of the new child.
+     */
+    static std::shared_ptr<Node> *attach(Node &node, std::shared_ptr<Node> leaf, bool left) {
+        node.children.reserve(2);
+        if (left) {
+            node.children.insert(node.children.begin(), std::move(leaf));
+            return &node.children.front();
+        }
+        node.children.push_back(std::move(leaf));
+        return &node.children.back();
+    }
+
+    /**
+     * @brief Find the node holding an equivalent key.
+     */
+    const Node *find_node(const T &key) const {
+        const Node *node = tree.root.get();
+        while (node) {
+            bool left = less(key, node->key);
+            if (!left && !less(node->key, key))
+                return node;
+            std::size_t split = Split::at(*node);
+            if (left)
+                node = split > 0 ? node->children[0].get() : nullptr;
+            else
+                node = split < node->children.size() ? node->children.back().get() : nullptr;
+        }
+        return nullptr;
+    }
+
+    /**
+     * @brief Set the number of keys and raise the depth limit along with it.
+     */
+    void grow(std::size_t keys) {
+        count = keys;
+        while (static_cast<double>(count) >= next_limit_at) {
+            ++depth_limit;
+            next_limit_at *= 1.5;
+        }
+    }
+
+    /**
+     * @brief Count the nodes of a subtree.
+     */
+    std::size_t subtree_size(const Node *node) {
+        std::size_t nodes = 0;
+        pending.assign(1, node);
+        while (!pending.empty()) {
+            const Node *next = pending.back();
+            pending.pop_back();
+            ++nodes;
+            for (const auto &child : next->children) {
+                pending.push_back(child.get());
+            }
+        }
+        return nodes;
+    }
+
+    /**
+     * @brief Rebuild the lowest ancestor of the new node whose child holds more than 2/3 of its subtree.
+     *
+     * Such a scapegoat exists whenever the new node is deeper than depth_limit.
+     */
+    void rebalance() {
+        std::size_t below = 1;  // the size of the subtree under path[i + 1], starting with the new leaf
+        for (std::size_t i = path.size() - 1; i-- > 0;) {
+            Node &node = **path[i];
+            std::size_t size = 1 + below;
+            for (auto &sibling : node.children) {
+                if (&sibling != path[i + 1])
+                    size += subtree_size(sibling.get());
+            }
+            if (3 * below > 2 * size) {
+                rebuild(*path[i], size);
+                return;
+            }
+            below = size;
+        }
+    }
+
+    /**
+     * @brief Replace a subtree by a perfectly balanced one holding the same nodes.
+     *
+     * @param slot The slot owning the subtree's root.
+     * @param size The number of nodes in it.
+     */
+    void rebuild(std::shared_ptr<Node> &slot, std::size_t size) {
+        // Move the nodes out of their slots in key order, so no reference count changes
+        sorted.clear();
+        sorted.reserve(size);
+        spine.clear();
+        std::shared_ptr<Node> *at = &slot;
+        while (at || !spine.empty()) {
+            for (; at; at = child(**at, true)) {
+                spine.emplace_back(at, child(**at, false));  // the sides are told apart before the left child moves
+            }
+            sorted.push_back(std::move(*spine.back().first));
+            at = spine.back().second;
+            spine.pop_back();
+        }
+        for (auto &node : sorted) {
+            node->children.clear();  // only empty slots are left
+        }
+        slot = link(sorted, 0, sorted.size());
+    }
+
+    /**
+     * @brief Copy a subtree node by node; recursion depth is the height, O(log n).
+     */
+    static std::shared_ptr<Node> clone(const std::shared_ptr<Node> &node) {
+        if (!node)
+            return nullptr;
+        auto copy = std::make_shared<Node>(node->key);
+        copy->children.reserve(node->children.size());
+        for (const auto &child : node->children) {
+            copy->children.push_back(clone(child));
+        }
+        return copy;
+    }
+
+    /**
+     * @brief Link a sorted run of nodes into a balanced subtree; recursion depth is O(log n).
+     */
+    static std::shared_ptr<Node> link(std::vector<std::shared_ptr<Node>> &nodes, std::size_t first, std::size_t last) {
+        if (first == last)
+            return nullptr;
+        std::size_t middle = first + (last - first) / 2;
+        std::shared_ptr<Node> node = std::move(nodes[middle]);
+        if (std::shared_ptr<Node> left = link(nodes, first, middle))
+            node->children.push_back(std::move(left));
+        if (std::shared_ptr<Node> right = link(nodes, middle + 1, last))
+            node->children.push_back(std::move(right));
+        return node;
+    }
+};
+
+#endif // TREESITERATORS_CPP_SEARCHTREE_HPP
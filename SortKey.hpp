@@ -0,0 +1,100 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_SORTKEY_HPP
+#define TREESITERATORS_CPP_SORTKEY_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <functional>  // For std::greater
+#include <utility>
+#include <vector>
+#include "KeySearch.hpp"  // For the TREE_HAS_SSE2 detection
+
+/**
+ * @brief Declares that T is ordered by a cheaper derived scalar, which can be computed for many keys at once.
+ *
+ * A specialization sets ENABLED, names the scalar as Type and provides
+ * compute(values, count, keys), which must write for every value a key
+ * whose operator< agrees with T's. make_min_heap and sort_by_key then
+ * compute the keys once, in one batch, and compare only those. Complex
+ * opts in with its squared magnitude.
+ *
+ * @tparam T The value type.
+ */
+template<typename T, typename = void>
+struct SortKey {
+    static constexpr bool ENABLED = false;
+};
+
+/**
+ * @brief Compute the sort keys of values in one batch.
+ */
+template<typename T>
+std::vector<typename SortKey<T>::Type> sort_keys(const std::vector<T> &values) {
+    std::vector<typename SortKey<T>::Type> keys(values.size());
+    SortKey<T>::compute(values.data(), values.size(), keys.data());
+    return keys;
+}
+
+/**
+ * @brief Arrange values as a binary min-heap, like std::make_heap with std::greater<T>.
+ *
+ * Types with a SortKey are heapified bottom-up on a parallel array of their
+ * keys, moved along with the values, so each comparison reads two scalars
+ * from a contiguous array instead of recomputing them.
+ *
+ * @param values The values; on return values[0] is a smallest one.
+ */
+template<typename T>
+void make_min_heap(std::vector<T> &values) {
+    if constexpr (SortKey<T>::ENABLED) {
+        auto keys = sort_keys(values);
+        const std::size_t size = values.size();
+        for (std::size_t start = size / 2; start-- > 0;) {
+            // Sift the value at start down into the heaps below it
+            T value = std::move(values[start]);
+            auto key = keys[start];
+            std::size_t hole = start;
+            for (std::size_t child = 2 * hole + 1; child < size; child = 2 * hole + 1) {
+                if (child + 1 < size && keys[child + 1] < keys[child])
+                    ++child;
+                if (!(keys[child] < key))
+                    break;
+                values[hole] = std::move(values[child]);
+                keys[hole] = keys[child];
+                hole = child;
+            }
+            values[hole] = std::move(value);
+            keys[hole] = key;
+        }
+    } else {
+        std::make_heap(values.begin(), values.end(), std::greater<T>());
+    }
+}
+
+/**
+ * @brief Sort values in ascending order, like std::sort; equivalent values may come in any order.
+ *
+ * Types with a SortKey are sorted as (key, value) pairs compared on the key alone.
+ *
+ * @param values The values.
+ */
+template<typename T>
+void sort_by_key(std::vector<T> &values) {
+    if constexpr (SortKey<T>::ENABLED) {
+        auto keys = sort_keys(values);
+        std::vector<std::pair<typename SortKey<T>::Type, T>> pairs;
+        pairs.reserve(values.size());
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            pairs.emplace_back(keys[i], std::move(values[i]));
+        }
+        std::sort(pairs.begin(), pairs.end(), [](const auto &a, const auto &b) { return a.first < b.first; });
+        for (std::size_t i = 0; i < values.size(); ++i) {
+            values[i] = std::move(pairs[i].second);
+        }
+    } else {
+        std::sort(values.begin(), values.end());
+    }
+}
+
+#endif // TREESITERATORS_CPP_SORTKEY_HPP
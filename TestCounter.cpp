@@ -18,7 +18,7 @@ struct ReporterCounter : public ConsoleReporter
         if (run_stats.numAsserts >= MIN_TESTS)
         {
             std::cout << "You have written " << run_stats.numAsserts << " tests! " << std::endl;
-            return_code = 0;
+            return_code = run_stats.numAssertsFailed == 0 && run_stats.numTestCasesFailed == 0 ? 0 : 1;
         }
         else
         {
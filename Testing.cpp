@@ -1,12 +1,26 @@
 //#define DOCTEST_CONFIG_IMPLEMENT_WITH_MAIN
 //oriyati0701@gmail.com
 
+#define TREE_ENABLE_STATS  // the tests check the operation counters too
+#define TREE_ENABLE_TRACING  // and the trace spans
 #include "doctest.h"
 #include <iostream>
 #include <vector>
 #include <algorithm> // For std::is_sorted
-//#include "Tree.hpp"
-#include "GUI.hpp"
+#include <thread>
+#include "Complex.hpp"
+#include "Tree.hpp"
+#include "TreeBinary.hpp"
+#include "TreeParser.hpp"
+#include "TreeWriter.hpp"
+#include "SearchTree.hpp"
+#include "BTree.hpp"
+#include "KeySearch.hpp"
+#include <sstream>
+#include <fstream>
+#include <cmath>
+#include <limits>
+#include <numeric>
 
 TEST_CASE("Test add_root") {
     Tree<int, 2> tree;
@@ -137,8 +151,6 @@ TEST_CASE("Test heap") {
     for(auto &each: keys){
         std::cout << each << "/n key  ";
     }
-    GUI<int> gui(tree);
-    gui.run();
     CHECK(keys == expected);
 }
 
@@ -246,3 +258,1113 @@ TEST_CASE("Heap_iterator_traverses_in_heap_order") {
     std::vector<int> expected = {3, 5, 4}; // Assuming min-heap for demonstration
     CHECK(traversal == expected);
 }
+
+TEST_CASE("Add_sub_node_by_pointer_returns_the_new_node") {
+    Tree<int, 2> tree;
+    tree.add_root(1);
+    auto *child = tree.add_sub_node(tree.get_root(), 2);
+    tree.add_sub_node(child, 3);
+    CHECK(child->key == 2);
+    CHECK(tree.get_root()->children[0]->children[0]->key == 3);
+    CHECK_THROWS_AS(tree.add_sub_node(nullptr, 4), std::invalid_argument);
+}
+
+TEST_CASE("Concurrent_add_sub_node_on_disjoint_subtrees") {
+    Tree<int, 8> tree;
+    tree.add_root(0);
+    for (int branch = 1; branch <= 4; ++branch) {
+        tree.add_sub_node(0, branch);
+    }
+    std::vector<std::thread> writers;
+    for (int branch = 1; branch <= 4; ++branch) {
+        writers.emplace_back([&tree, branch]() {
+            auto *parent = tree.get_root()->children[static_cast<size_t>(branch - 1)].get();
+            for (int i = 0; i < 1000; ++i) {
+                tree.add_sub_node(parent, branch * 10000 + i);
+            }
+            tree.add_sub_node(branch, -branch);  // by value, searching while others insert
+        });
+    }
+    for (auto &writer : writers) {
+        writer.join();
+    }
+    for (auto &branch : tree.get_root()->children) {
+        CHECK(branch->children.size() == 1001);
+        CHECK(branch->children.back()->key == -branch->key);
+    }
+}
+
+TEST_CASE("Add_sub_nodes_appends_all_children_in_order") {
+    Tree<int, 4> tree;
+    tree.add_root(1);
+    std::vector<int> children = {2, 3, 4};
+    tree.add_sub_nodes(1, children.begin(), children.end());
+    tree.add_sub_nodes(tree.get_root()->children[0].get(), children.begin(), children.begin() + 1);
+    REQUIRE(tree.get_root()->children.size() == 3);
+    CHECK(tree.get_root()->children[2]->key == 4);
+    CHECK(tree.get_root()->children[0]->children[0]->key == 2);
+    CHECK_THROWS_AS(tree.add_sub_nodes(9, children.begin(), children.end()), std::logic_error);
+}
+
+TEST_CASE("Build_from_parent_array_links_every_node") {
+    Tree<int, 2> tree;
+    std::vector<size_t> parents = {2, 2, Tree<int, 2>::NO_PARENT, 0, 0};
+    std::vector<int> keys = {2, 3, 1, 4, 5};
+    tree.build_from_parent_array(parents, keys);
+
+    std::vector<int> traversal;
+    for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it) {
+        traversal.push_back((*it)->key);
+    }
+    std::vector<int> expected = {1, 2, 4, 5, 3};
+    CHECK(traversal == expected);
+    CHECK_THROWS_AS(tree.build_from_parent_array(parents, keys), std::invalid_argument);
+}
+
+TEST_CASE("Build_from_parent_array_rejects_invalid_input") {
+    Tree<int, 2> tree;
+    std::vector<int> keys = {1, 2, 3};
+    CHECK_THROWS_AS(tree.build_from_parent_array({1, 2, 1}, keys), std::invalid_argument);
+    CHECK_THROWS_AS(tree.build_from_parent_array({Tree<int, 2>::NO_PARENT, 2, 1}, keys), std::logic_error);
+    CHECK_THROWS_AS(tree.build_from_parent_array({Tree<int, 2>::NO_PARENT, 0, 7}, keys), std::logic_error);
+    CHECK(tree.get_root() == nullptr);
+}
+
+TEST_CASE("Build_from_edges_matches_add_sub_node") {
+    std::vector<std::pair<Complex, Complex>> edges = {
+        {Complex(5, 5), Complex(3, 3)}, {Complex(5, 5), Complex(8, 8)}, {Complex(3, 3), Complex(2, 2)}};
+    Tree<Complex> tree;
+    tree.build_from_edges(edges);
+    REQUIRE(tree.get_root()->children.size() == 2);
+    CHECK(tree.get_root()->key == Complex(5, 5));
+    CHECK(tree.get_root()->children[0]->children[0]->key == Complex(2, 2));
+
+    Tree<Complex> orphan;
+    edges.push_back({Complex(1, 1), Complex(0, 0)});
+    CHECK_THROWS_AS(orphan.build_from_edges(edges), std::logic_error);
+}
+
+TEST_CASE("Binary_file_round_trips_through_view_and_loader") {
+    Tree<Complex> tree;
+    tree.add_root(Complex(5, 5));
+    tree.add_sub_node(Complex(5, 5), Complex(3, 3));
+    tree.add_sub_node(Complex(5, 5), Complex(8, 8));
+    tree.add_sub_node(Complex(3, 3), Complex(2, 2));
+    tree.add_sub_node(Complex(3, 3), Complex(4, 4));
+    tree.add_sub_node(Complex(8, 8), Complex(7, 7));
+    const std::string path = "tree_binary_test.bin";
+    save_binary(tree, path);
+
+    {
+        TreeView<Complex> view(path);
+        CHECK(view.size() == 6);
+        CHECK(view.get_root()->key == Complex(5, 5));
+        std::vector<Complex> expected, actual;
+        for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it)
+            expected.push_back((*it)->key);
+        for (auto it = view.begin_post_order(); it != view.end_post_order(); ++it)
+            actual.push_back((*it)->key);
+        CHECK(actual == expected);
+
+        expected.clear(), actual.clear();
+        for (auto it = tree.begin_in_order(); it != tree.end_in_order(); ++it)
+            expected.push_back((*it)->key);
+        for (auto it = view.begin_in_order(); it != view.end_in_order(); ++it)
+            actual.push_back((*it)->key);
+        CHECK(actual == expected);
+
+        expected.clear(), actual.clear();
+        for (auto it = tree.begin_bfs_scan(); it != tree.end_bfs_scan(); ++it)
+            expected.push_back((*it)->key);
+        for (auto it = view.begin_bfs_scan(); it != view.end_bfs_scan(); ++it)
+            actual.push_back((*it)->key);
+        CHECK(actual == expected);
+    }
+
+    Tree<Complex> loaded = load_binary<Complex>(path);
+    CHECK(loaded.get_root()->children[1]->children[0]->key == Complex(7, 7));
+    CHECK_THROWS_AS((TreeView<Complex, 3>(path)), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Binary_file_with_corrupt_counts_is_rejected") {
+    Tree<int> tree;
+    tree.add_root(1);
+    tree.add_sub_node(1, 2);
+    tree.add_sub_node(1, 3);
+    tree.add_sub_node(2, 4);
+    const std::string path = "tree_binary_corrupt_test.bin";
+    std::ostringstream saved;
+    write_binary(tree, saved);
+    const std::string original = saved.str();
+    TreeBinaryHeader header;
+    std::memcpy(&header, original.data(), sizeof(header));
+    auto write_file = [&path](const std::string &bytes) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc) << bytes;
+    };
+    auto set_count = [&header](std::string &bytes, std::size_t index, std::uint32_t count) {
+        std::memcpy(&bytes[header.counts_offset + index * sizeof(count)], &count, sizeof(count));
+    };
+
+    std::string over = original;
+    set_count(over, 3, 1);  // a leaf claims a child past the last node
+    write_file(over);
+    CHECK_THROWS_AS((TreeView<int>(path)), std::runtime_error);
+    CHECK_THROWS_AS(load_binary<int>(path), std::runtime_error);
+
+    std::string under = original;
+    set_count(under, 1, 0);  // node 4 is no longer anyone's child
+    write_file(under);
+    CHECK_THROWS_AS((TreeView<int>(path)), std::runtime_error);
+
+    std::string wide = original;
+    set_count(wide, 0, 3);  // Tree does not enforce its degree, so this is a valid file
+    set_count(wide, 1, 0);
+    write_file(wide);
+    CHECK(TreeView<int>(path).child_count(0) == 3);
+
+    std::string huge = original;
+    std::uint64_t wrapping = std::uint64_t{1} << 62;  // node_count * sizeof(int) wraps to 0
+    std::memcpy(&huge[offsetof(TreeBinaryHeader, node_count)], &wrapping, sizeof(wrapping));
+    write_file(huge);
+    CHECK_THROWS_AS((TreeView<int>(path)), std::runtime_error);
+
+    write_file(original.substr(0, original.size() - sizeof(std::uint32_t)));
+    CHECK_THROWS_AS(load_binary<int>(path), std::runtime_error);
+
+    write_file(original);
+    CHECK(load_binary<int>(path).get_root()->children[0]->children[0]->key == 4);
+
+    tree.add_sub_node(1, 5);  // a third child under a binary root
+    save_binary(tree, path);
+    Tree<int> loaded = load_binary<int>(path);
+    REQUIRE(loaded.get_root()->children.size() == 3);
+    CHECK(loaded.get_root()->children[2]->key == 5);
+    std::vector<int> viewed;
+    TreeView<int> view(path);
+    for (auto it = view.begin_bfs_scan(); it != view.end_bfs_scan(); ++it)
+        viewed.push_back((*it)->key);
+    CHECK(viewed == std::vector<int>{1, 2, 3, 5, 4});
+    std::remove(path.c_str());
+}
+
+TEST_CASE("Parse_edge_list_with_tab_separated_complex_keys") {
+    std::istringstream input("# demo tree\n5 + 5i\t3 + 3i\n5 + 5i\t8 + 8i\n\n3 + 3i\t2.000000 + -2.000000i\n");
+    Tree<Complex> tree = parse_edge_list<Complex>(input);
+    REQUIRE(tree.get_root()->children.size() == 2);
+    CHECK(tree.get_root()->key == Complex(5, 5));
+    CHECK(tree.get_root()->children[0]->children[0]->key == Complex(2, -2));
+
+    std::istringstream orphan("1 2\n3 4\n");
+    CHECK_THROWS_AS(parse_edge_list<int>(orphan), std::logic_error);
+    std::istringstream malformed("1 2 3\n");
+    CHECK_THROWS_AS(parse_edge_list<int>(malformed), std::invalid_argument);
+}
+
+TEST_CASE("Parse_newick_keeps_child_order") {
+    std::istringstream input("((e:1.5)b, (f)c, 'd d')a;");
+    Tree<std::string, 3> tree = parse_newick<std::string, 3>(input);
+    std::vector<std::string> traversal;
+    for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it) {
+        traversal.push_back((*it)->key);
+    }
+    std::vector<std::string> expected = {"a", "b", "e", "c", "f", "d d"};
+    CHECK(traversal == expected);
+
+    std::istringstream unbalanced("((1)2;");
+    CHECK_THROWS_AS((parse_newick<int>(unbalanced)), std::invalid_argument);
+}
+
+TEST_CASE("Parse_json_nested_objects") {
+    std::istringstream input(R"({"children": [{"key": 2, "children": []}, {"key": 3, "note": {"x": [1]}}], "key": 1})");
+    Tree<int> tree = parse_json<int>(input);
+    std::vector<int> traversal;
+    for (auto it = tree.begin_bfs_scan(); it != tree.end_bfs_scan(); ++it) {
+        traversal.push_back((*it)->key);
+    }
+    std::vector<int> expected = {1, 2, 3};
+    CHECK(traversal == expected);
+
+    std::istringstream keyless(R"({"children": []})");
+    CHECK_THROWS_AS(parse_json<int>(keyless), std::invalid_argument);
+}
+
+TEST_CASE("FromString_reads_toString_output") {
+    CHECK(fromString<Complex>(Complex(1.5, -2).toString()) == Complex(1.5, -2));
+    CHECK(fromString<Complex>("-3i") == Complex(0, -3));
+    CHECK(fromString<int>("+42") == 42);
+    CHECK_THROWS_AS(fromString<int>("4x"), std::invalid_argument);
+
+    const double inf = std::numeric_limits<double>::infinity();
+    for (Complex value : {Complex(inf, 1), Complex(1, inf), Complex(-inf, -inf), Complex(0, -inf)}) {
+        CHECK(fromString<Complex>(value.toString()) == value);
+    }
+    CHECK(fromString<Complex>("-Infinity + 2i") == Complex(-inf, 2));
+    CHECK(fromString<Complex>("infi") == Complex(0, inf));
+    Complex nan = fromString<Complex>(Complex(1, std::numeric_limits<double>::quiet_NaN()).toString());
+    CHECK(nan.real == 1);
+    CHECK(std::isnan(nan.imaginary));
+    CHECK_THROWS_AS(fromString<Complex>("inf + 1"), std::invalid_argument);
+}
+
+TEST_CASE("Newick_and_json_writers_round_trip_through_the_parsers") {
+    Tree<Complex> tree;
+    tree.add_root(Complex(5, 5));
+    tree.add_sub_node(Complex(5, 5), Complex(3, -3.5));
+    tree.add_sub_node(Complex(5, 5), Complex(8, 8));
+    tree.add_sub_node(Complex(3, -3.5), Complex(0.1, 2));
+
+    std::ostringstream newick, json;
+    write_newick(tree, newick);
+    write_json(tree, json);
+    CHECK(newick.str() == "((0.1 + 2i)3 - 3.5i,8 + 8i)5 + 5i;\n");
+
+    std::istringstream newick_in(newick.str()), json_in(json.str());
+    for (Tree<Complex> parsed : {parse_newick<Complex>(newick_in), parse_json<Complex>(json_in)}) {
+        std::vector<Complex> expected, actual;
+        for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it)
+            expected.push_back((*it)->key);
+        for (auto it = parsed.begin_pre_order(); it != parsed.end_pre_order(); ++it)
+            actual.push_back((*it)->key);
+        CHECK(actual == expected);
+    }
+}
+
+TEST_CASE("Dot_writer_escapes_string_labels") {
+    Tree<std::string, 3> tree;
+    tree.add_root("a \"root\"");
+    tree.add_sub_node("a \"root\"", "b");
+    std::ostringstream dot;
+    write_dot(tree, dot);
+    CHECK(dot.str() == "digraph Tree {\n  n0 [label=\"a \\\"root\\\"\"];\n  n1 [label=\"b\"];\n  n0 -> n1;\n}\n");
+
+    std::ostringstream newick;
+    write_newick(tree, newick);
+    std::istringstream newick_in(newick.str());
+    CHECK((parse_newick<std::string, 3>(newick_in).get_root()->key == "a \"root\""));
+
+    Tree<std::string, 3> quoted;
+    quoted.add_root(" padded ");
+    quoted.add_sub_node(" padded ", "");
+    quoted.add_sub_node(" padded ", "it's");
+    std::ostringstream quoted_out;
+    write_newick(quoted, quoted_out);
+    CHECK(quoted_out.str() == "('','it''s')' padded ';\n");
+    std::istringstream quoted_in(quoted_out.str());
+    Tree<std::string, 3> parsed = parse_newick<std::string, 3>(quoted_in);
+    CHECK(parsed.get_root()->key == " padded ");
+    REQUIRE(parsed.get_root()->children.size() == 2);
+    CHECK(parsed.get_root()->children[0]->key.empty());
+    CHECK(parsed.get_root()->children[1]->key == "it's");
+}
+
+TEST_CASE("Writers_handle_bool_keys_non_finite_json_keys_and_dot_control_characters") {
+    Tree<bool> flags;
+    flags.add_root(true);
+    flags.add_sub_node(true, false);
+    std::ostringstream json, newick;
+    write_json(flags, json);
+    write_newick(flags, newick);
+    CHECK(json.str() == "{\"key\":true,\"children\":[{\"key\":false}]}\n");
+    CHECK(newick.str() == "(false)true;\n");
+    std::istringstream json_in(json.str());
+    CHECK_FALSE(parse_json<bool>(json_in).get_root()->children[0]->key);
+
+    Tree<double> numbers;
+    numbers.add_root(1.5);
+    numbers.add_sub_node(1.5, std::numeric_limits<double>::quiet_NaN());
+    std::ostringstream rejected;
+    CHECK_THROWS_AS(write_json(numbers, rejected), std::runtime_error);
+    Tree<double> infinite;
+    infinite.add_root(-std::numeric_limits<double>::infinity());
+    CHECK_THROWS_AS(write_json(infinite, rejected), std::runtime_error);
+
+    Tree<std::string> labels;
+    labels.add_root(std::string("a\\b\nc\td\x01"));
+    std::ostringstream dot;
+    write_dot(labels, dot);
+    CHECK(dot.str() == "digraph Tree {\n  n0 [label=\"a\\\\b\\ncd\"];\n}\n");
+}
+
+TEST_CASE("Destroying_a_deep_chain_does_not_recurse") {
+    const size_t depth = 500000;
+    std::vector<size_t> parents(depth);
+    std::vector<int> keys(depth);
+    for (size_t i = 0; i < depth; ++i) {
+        parents[i] = i == 0 ? Tree<int>::NO_PARENT : i - 1;
+        keys[i] = static_cast<int>(i);
+    }
+    auto tree = std::make_unique<Tree<int>>();
+    tree->build_from_parent_array(parents, keys);
+    Tree<int> copy = *tree;
+    tree.reset();  // the copy still shares every node
+    CHECK(copy.get_root()->children[0]->key == 1);
+    copy = Tree<int>();
+    CHECK(copy.get_root() == nullptr);
+}
+
+TEST_CASE("Stats_count_allocations_searches_traversals_and_heap_rebuilds") {
+    Tree<int, 2> tree;
+    tree.add_root(1);
+    tree.add_sub_node(1, 2);
+    tree.add_sub_node(1, 3);
+    tree.add_sub_node(3, 4);  // found as the third node in breadth-first order
+    TreeStats stats = tree.stats();
+    CHECK(stats.node_allocations == 4);
+    CHECK(stats.parent_searches == 3);
+    CHECK(stats.parent_search_nodes == 5);
+    CHECK(stats.longest_parent_search == 3);
+
+    for (auto it = tree.begin_pre_order(); it != tree.end_pre_order(); ++it) {
+    }
+    stats = tree.stats();
+    CHECK(stats.traversals == 1);
+    CHECK(stats.nodes_visited == 4);
+    CHECK(stats.peak_iterator_buffer == 3);  // the stack holds the path 1, 3, 4
+
+    tree.begin_heap();
+    CHECK(tree.stats().heap_rebuilds == 1);
+    tree.reset_stats();
+    CHECK(tree.stats().node_allocations == 0);
+}
+
+TEST_CASE("Tracing_reports_builds_traversals_and_heapify_as_chrome_events") {
+    struct Collector : TraceSink {
+        std::vector<std::pair<std::string, size_t>> spans;
+        void span(const char *name, double, double duration_us, size_t nodes) override {
+            CHECK(duration_us >= 0);
+            spans.emplace_back(name, nodes);
+        }
+    } collector;
+    set_trace_sink(&collector);
+    Tree<int, 2> tree;
+    tree.build_from_parent_array({Tree<int>::NO_PARENT, 0, 0}, {1, 2, 3});
+    for (auto it = tree.begin_bfs_scan(); it != tree.end_bfs_scan(); ++it) {
+    }
+    tree.myHeap();
+    set_trace_sink(nullptr);
+    tree.myHeap();  // no longer traced
+    CHECK(collector.spans.front() == std::make_pair(std::string("build_from_parent_array"), size_t(3)));
+    CHECK(collector.spans[1] == std::make_pair(std::string("traverse_bfs_scan"), size_t(3)));
+    CHECK(collector.spans.back() == std::make_pair(std::string("my_heap"), size_t(3)));
+
+    {
+        ChromeTraceWriter writer("tree_trace_test.json");
+        set_trace_sink(&writer);
+        tree.myHeap();
+        set_trace_sink(nullptr);
+    }
+    std::ifstream in("tree_trace_test.json");
+    std::string json((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    in.close();
+    std::remove("tree_trace_test.json");
+    CHECK(json.rfind("{\"traceEvents\":[", 0) == 0);
+    CHECK(json.find("\"name\":\"my_heap\",\"cat\":\"tree\",\"ph\":\"X\"") != std::string::npos);
+    CHECK(json.find("\"args\":{\"nodes\":3}}\n],\"displayTimeUnit\":\"ms\"}") != std::string::npos);
+}
+
+TEST_CASE("Copies_of_a_traced_iterator_advance_on_different_threads") {
+    struct Collector : TraceSink {
+        size_t nodes = 0;
+        void span(const char *, double, double, size_t count) override {
+            nodes = count;
+        }
+    } collector;
+    const size_t size = 1000;
+    std::vector<size_t> parents(size);
+    std::vector<int> keys(size);
+    for (size_t i = 0; i < size; ++i) {
+        parents[i] = i == 0 ? Tree<int>::NO_PARENT : (i - 1) / 2;
+        keys[i] = static_cast<int>(i);
+    }
+    Tree<int> tree;
+    tree.build_from_parent_array(parents, keys);
+    set_trace_sink(&collector);
+    {
+        auto first = tree.begin_pre_order();  // counts the root once
+        auto walk = [&tree, first]() {
+            for (auto it = first; it != tree.end_pre_order(); ++it) {
+            }
+        };
+        std::thread left(walk), right(walk);
+        left.join();
+        right.join();
+    }
+    set_trace_sink(nullptr);
+    CHECK(collector.nodes == 1 + 2 * (size - 1));
+}
+
+TEST_CASE("Traversals_are_lazy_and_handle_deep_chains") {
+    const size_t depth = 200000;
+    std::vector<size_t> parents(depth);
+    std::vector<int> keys(depth);
+    for (size_t i = 0; i < depth; ++i) {
+        parents[i] = i == 0 ? Tree<int>::NO_PARENT : i - 1;
+        keys[i] = static_cast<int>(i);
+    }
+    Tree<int> tree;
+    tree.build_from_parent_array(parents, keys);
+
+    size_t count = 0;
+    int last = -1;
+    for (auto it = tree.begin_post_order(); it != tree.end_post_order(); ++it) {
+        last = (*it)->key;
+        ++count;
+    }
+    CHECK(count == depth);
+    CHECK(last == 0);
+    CHECK((*tree.begin_in_order())->key == static_cast<int>(depth - 1));
+
+    std::vector<int> visited;
+    tree.visit<PreOrder>([&visited](Tree<int>::Node &node) { visited.push_back(node.key); });
+    CHECK(visited == keys);
+    const Tree<int> &view = tree;
+    count = 0;
+    view.visit<BreadthFirst>([&count](const Tree<int>::Node &) { ++count; });
+    CHECK(count == depth);
+}
+
+TEST_CASE("Iterators_are_standard_forward_iterators") {
+    using It = Tree<int>::PreOrderIterator;
+    static_assert(std::is_same<std::iterator_traits<It>::iterator_category, std::forward_iterator_tag>::value,
+                  "traversal iterators are forward iterators");
+    static_assert(std::is_same<std::iterator_traits<It>::reference, const std::shared_ptr<Tree<int>::Node> &>::value,
+                  "dereferencing yields the stored shared_ptr");
+    Tree<int> tree;
+    tree.add_root(1);
+    tree.add_sub_node(1, 2);
+    tree.add_sub_node(1, 3);
+    tree.add_sub_node(2, 4);
+
+    auto is_three = [](const std::shared_ptr<Tree<int>::Node> &node) { return node->key == 3; };
+    auto found = std::find_if(tree.begin_pre_order(), tree.end_pre_order(), is_three);
+    CHECK(found->get() == tree.get_root()->children[1].get());
+    CHECK(std::count_if(tree.begin_bfs_scan(), tree.end_bfs_scan(),
+                        [](const std::shared_ptr<Tree<int>::Node> &node) { return node->key % 2 == 0; }) == 2);
+    CHECK(std::distance(tree.begin_post_order(), tree.end_post_order()) == 4);
+
+    auto it = tree.begin_in_order();
+    auto copy = it++;
+    CHECK((*copy)->key == 4);
+    CHECK((*it)->key == 2);
+    CHECK(copy != it);
+    ++copy;
+    CHECK(copy == it);  // copies advance independently and compare by position
+    CHECK(tree.end_dfs_scan() == Tree<int>::DFSIterator());
+}
+
+TEST_CASE("Traversal_ranges_work_with_range_for_and_views") {
+    Tree<int> tree;
+    tree.add_root(1);
+    tree.add_sub_node(1, 2);
+    tree.add_sub_node(1, 3);
+    tree.add_sub_node(2, 4);
+    tree.add_sub_node(2, 5);
+
+    std::vector<int> keys;
+    for (const auto &node : tree.post_order()) {
+        keys.push_back(node->key);
+    }
+    CHECK(keys == std::vector<int>{4, 5, 2, 3, 1});
+    CHECK(tree.bfs().begin() != tree.bfs().end());
+    CHECK(Tree<int>().dfs().begin() == Tree<int>().dfs().end());
+
+#if defined(__cpp_lib_ranges)
+    static_assert(std::ranges::view<decltype(tree.bfs())>, "traversal ranges are views");
+    static_assert(std::ranges::borrowed_range<decltype(tree.bfs())>, "their iterators point into the tree");
+    tree.reset_stats();
+    keys.clear();
+    for (int key : tree.bfs() | std::views::take(2)
+                   | std::views::transform([](const std::shared_ptr<Tree<int>::Node> &node) { return node->key; })) {
+        keys.push_back(key);
+    }
+    CHECK(keys == std::vector<int>{1, 2});
+    CHECK(tree.stats().nodes_visited <= 3);  // take stops after advancing past its last element at most once
+    auto evens = tree.pre_order()
+                 | std::views::filter([](const std::shared_ptr<Tree<int>::Node> &node) { return node->key % 2 == 0; });
+    CHECK(std::ranges::distance(evens) == 2);
+#endif
+}
+
+#if defined(TREE_HAS_COROUTINES)
+TEST_CASE("Generators_yield_every_order_lazily") {
+    Tree<int> tree;
+    tree.add_root(1);
+    tree.add_sub_node(1, 2);
+    tree.add_sub_node(1, 3);
+    tree.add_sub_node(2, 4);
+    tree.add_sub_node(2, 5);
+
+    auto keys_of = [](auto &&range) {
+        std::vector<int> keys;
+        for (const auto &node : range) {
+            keys.push_back(node->key);
+        }
+        return keys;
+    };
+    CHECK(keys_of(tree.generate<PreOrder>()) == keys_of(tree.pre_order()));
+    CHECK(keys_of(tree.generate<PostOrder>()) == std::vector<int>{4, 5, 2, 3, 1});
+    CHECK(keys_of(tree.generate<InOrder>()) == std::vector<int>{4, 2, 5, 1, 3});
+    CHECK(keys_of(tree.generate<BreadthFirst>()) == std::vector<int>{1, 2, 3, 4, 5});
+    CHECK(keys_of(tree.generate<DepthFirst>()) == keys_of(tree.dfs()));
+    CHECK(keys_of(Tree<int>().generate<PreOrder>()).empty());
+
+    auto generator = tree.generate<PostOrder>();
+    auto it = generator.begin();
+    CHECK((*it)->key == 4);  // destroying the generator mid-walk frees the suspended frames
+
+    const size_t depth = 100000;
+    std::vector<size_t> parents(depth);
+    std::vector<int> chain(depth);
+    for (size_t i = 0; i < depth; ++i) {
+        parents[i] = i == 0 ? Tree<int>::NO_PARENT : i - 1;
+        chain[i] = static_cast<int>(i);
+    }
+    Tree<int> deep;
+    deep.build_from_parent_array(parents, chain);
+    size_t count = 0;
+    int last = -1;
+    for (const auto &node : deep.generate<PostOrder>()) {
+        last = node->key;
+        ++count;
+    }
+    CHECK(count == depth);
+    CHECK(last == 0);
+    auto partial = deep.generate<PostOrder>();
+    CHECK((*partial.begin())->key == static_cast<int>(depth - 1));
+}
+#endif
+
+TEST_CASE("Level_iterator_yields_whole_levels_with_their_depth") {
+    Tree<int, 3> tree;
+    tree.add_root(1);
+    tree.add_sub_node(1, 2);
+    tree.add_sub_node(1, 3);
+    tree.add_sub_node(1, 4);
+    tree.add_sub_node(2, 5);
+    tree.add_sub_node(4, 6);
+    tree.add_sub_node(6, 7);
+
+    std::vector<std::vector<int>> rows;
+    std::vector<size_t> depths;
+    for (const auto &level : tree.levels()) {
+        depths.push_back(level.depth());
+        std::vector<int> row;
+        for (Tree<int, 3>::Node *node : level) {
+            row.push_back(node->key);
+        }
+        rows.push_back(row);
+    }
+    CHECK(depths == std::vector<size_t>{0, 1, 2, 3});
+    CHECK(rows == std::vector<std::vector<int>>{{1}, {2, 3, 4}, {5, 6}, {7}});
+
+    std::vector<int> flat;
+    for (const auto &row : rows) {
+        flat.insert(flat.end(), row.begin(), row.end());
+    }
+    std::vector<int> bfs;
+    for (const auto &node : tree.bfs()) {
+        bfs.push_back(node->key);
+    }
+    CHECK(flat == bfs);
+
+    auto it = tree.begin_levels();
+    ++it;
+    auto level = *it;
+    CHECK(level.size() == 3);
+    CHECK(level[2]->key == 4);
+    CHECK(std::accumulate(level.begin(), level.end(), 0,
+                          [](int sum, const Tree<int, 3>::Node *node) { return sum + node->key; }) == 9);
+    CHECK(std::distance(tree.begin_levels(), tree.end_levels()) == 4);
+    CHECK(Tree<int>().begin_levels() == Tree<int>().end_levels());
+
+    tree.reset_stats();
+    for (auto lit = tree.begin_levels(); lit != tree.end_levels(); ++lit) {
+    }
+    CHECK(tree.stats().nodes_visited == 7);
+    CHECK(tree.stats().peak_iterator_buffer == 3);
+}
+
+TEST_CASE("Pruned_traversals_stop_at_a_depth_and_skip_subtrees") {
+    Tree<int, 3> tree;
+    tree.add_root(1);
+    tree.add_sub_node(1, 2);
+    tree.add_sub_node(1, 3);
+    tree.add_sub_node(1, 4);
+    tree.add_sub_node(2, 5);
+    tree.add_sub_node(2, 6);
+    tree.add_sub_node(3, 7);
+    tree.add_sub_node(5, 8);
+
+    auto keys_of = [](auto &&range) {
+        std::vector<int> keys;
+        for (const auto &node : range) {
+            keys.push_back(node->key);
+        }
+        return keys;
+    };
+    CHECK(keys_of(tree.dfs(Tree<int, 3>::NO_DEPTH_LIMIT)) == keys_of(tree.dfs()));
+    CHECK(keys_of(tree.dfs(0)) == std::vector<int>{1});
+    CHECK(keys_of(tree.dfs(1)) == std::vector<int>{1, 2, 3, 4});
+    CHECK(keys_of(tree.bfs(2)) == std::vector<int>{1, 2, 3, 4, 5, 6, 7});
+
+    auto skip_two = [](const Tree<int, 3>::Node &node) { return node.key == 2; };
+    CHECK(keys_of(tree.dfs(Tree<int, 3>::NO_DEPTH_LIMIT, skip_two)) == std::vector<int>{1, 3, 7, 4});
+    CHECK(keys_of(tree.bfs(Tree<int, 3>::NO_DEPTH_LIMIT, skip_two)) == std::vector<int>{1, 3, 4, 7});
+    CHECK(keys_of(tree.pruned<PostOrder>(2, skip_two)) == std::vector<int>{7, 3, 4, 1});
+    CHECK(keys_of(tree.dfs(5, [](const Tree<int, 3>::Node &node) { return node.key == 1; })).empty());
+
+    tree.reset_stats();
+    int calls = 0;
+    auto counting = [&calls](const Tree<int, 3>::Node &node) {
+        ++calls;
+        return node.key == 2;
+    };
+    auto pruned = tree.dfs(Tree<int, 3>::NO_DEPTH_LIMIT, counting);
+    CHECK(std::distance(pruned.begin(), pruned.end()) == 4);
+    CHECK(calls == 5);  // the root, its three children and 7; the subtree of 2 is never entered
+    CHECK(tree.stats().nodes_visited == 4);
+
+    auto it = tree.bfs(1).begin();
+    auto copy = it;
+    ++it;
+    copy = it;  // iterators over a capturing predicate stay assignable
+    CHECK((*copy)->key == 2);
+}
+
+TEST_CASE("Reverse_traversals_and_bidirectional_in_order") {
+    Tree<int> tree;
+    tree.add_root(1);
+    tree.add_sub_node(1, 2);
+    tree.add_sub_node(1, 3);
+    tree.add_sub_node(2, 4);
+    tree.add_sub_node(2, 5);
+    tree.add_sub_node(3, 6);
+
+    auto keys_of = [](auto &&range) {
+        std::vector<int> keys;
+        for (const auto &node : range) {
+            keys.push_back(node->key);
+        }
+        return keys;
+    };
+    auto reversed = [&keys_of](auto &&range) {
+        std::vector<int> keys = keys_of(range);
+        std::reverse(keys.begin(), keys.end());
+        return keys;
+    };
+    CHECK(keys_of(tree.reverse_pre_order()) == reversed(tree.pre_order()));
+    CHECK(keys_of(tree.reverse_post_order()) == reversed(tree.post_order()));
+    CHECK(keys_of(tree.reverse_bfs()) == reversed(tree.bfs()));
+    CHECK(keys_of(tree.reverse_bfs()) == std::vector<int>{6, 5, 4, 3, 2, 1});
+    CHECK(keys_of(Tree<int>().reverse_bfs()).empty());
+
+    static_assert(std::is_same<std::iterator_traits<Tree<int>::InOrderIterator>::iterator_category,
+                               std::bidirectional_iterator_tag>::value, "in-order steps both ways");
+    std::vector<int> backwards;
+    for (auto it = std::make_reverse_iterator(tree.end_in_order());
+         it != std::make_reverse_iterator(tree.begin_in_order()); ++it) {
+        backwards.push_back((*it)->key);
+    }
+    CHECK(backwards == reversed(tree.in_order()));
+    CHECK(backwards == std::vector<int>{3, 6, 1, 5, 2, 4});  // a lone child is a left child
+
+    auto it = tree.begin_in_order();
+    std::advance(it, 4);
+    CHECK((*it)->key == 6);
+    --it;
+    --it;
+    CHECK((*it)->key == 5);
+    CHECK((*std::prev(tree.end_in_order()))->key == 3);
+    CHECK(Tree<int>().begin_in_order() == Tree<int>().end_in_order());
+
+    Tree<int, 3> ternary;
+    ternary.add_root(1);
+    ternary.add_sub_node(1, 2);
+    ternary.add_sub_node(1, 3);
+    ternary.add_sub_node(1, 4);
+    ternary.add_sub_node(3, 5);
+    std::vector<int> down;
+    for (auto rit = ternary.end_in_order(); rit != ternary.begin_in_order();) {
+        --rit;
+        down.push_back((*rit)->key);
+    }
+    CHECK(down == reversed(ternary.in_order()));
+    CHECK(keys_of(ternary.reverse_pre_order()) == reversed(ternary.pre_order()));
+
+#if defined(TREE_HAS_COROUTINES)
+    CHECK(keys_of(tree.generate<ReversePreOrder>()) == keys_of(tree.reverse_pre_order()));
+    CHECK(keys_of(tree.generate<ReverseBreadthFirst>()) == keys_of(tree.reverse_bfs()));
+#endif
+#if defined(__cpp_lib_ranges)
+    static_assert(std::ranges::bidirectional_range<decltype(tree.in_order())>, "in-order ranges reverse");
+    std::vector<int> viewed;
+    for (const auto &node : tree.in_order() | std::views::reverse | std::views::take(2)) {
+        viewed.push_back(node->key);
+    }
+    CHECK(viewed == std::vector<int>{3, 6});
+#endif
+}
+
+TEST_CASE("D_ary_in_order_splits_the_children_and_sorts_search_trees") {
+    // a 3-ary search tree: the keys of the first two children are smaller than their parent's,
+    // those of the third larger, so the default ceil(k/2) split yields the keys sorted
+    Tree<int, 3> tree;
+    tree.add_root(50);
+    tree.add_sub_node(50, 20);
+    tree.add_sub_node(50, 40);
+    tree.add_sub_node(50, 80);
+    tree.add_sub_node(20, 10);
+    tree.add_sub_node(20, 15);
+    tree.add_sub_node(20, 30);
+    tree.add_sub_node(40, 35);
+    tree.add_sub_node(80, 60);
+    tree.add_sub_node(80, 70);
+    tree.add_sub_node(80, 90);
+
+    std::vector<int> keys;
+    for (auto it = tree.begin_in_order(); it != tree.end_in_order(); ++it) {
+        keys.push_back((*it)->key);
+    }
+    CHECK(keys == std::vector<int>{10, 15, 20, 30, 35, 40, 50, 60, 70, 80, 90});
+
+    std::vector<int> visited;
+    tree.visit<InOrder>([&visited](const Tree<int, 3>::Node &node) { visited.push_back(node.key); });
+    CHECK(visited == keys);
+
+    keys.clear();
+    for (const auto &node : tree.in_order<SplitAt<1>>()) {
+        keys.push_back(node->key);
+    }
+    CHECK(keys == std::vector<int>{10, 20, 15, 30, 50, 35, 40, 60, 80, 70, 90});
+    auto last = tree.in_order<SplitAt<1>>().end();
+    CHECK((*--last)->key == 90);
+
+    const std::string path = "tree_in_order_test.bin";
+    save_binary(tree, path);
+    {
+        TreeView<int, 3> view(path);
+        std::vector<int> viewed;
+        for (auto it = view.begin_in_order(); it != view.end_in_order(); ++it)
+            viewed.push_back((*it)->key);
+        CHECK(viewed == visited);
+    }
+    std::remove(path.c_str());
+}
+
+TEST_CASE("SearchTree_keeps_keys_sorted_and_balanced") {
+    SearchTree<int> set;
+    CHECK(set.empty());
+    CHECK(set.begin() == set.end());
+    for (int key = 0; key < 1000; ++key) {
+        CHECK(set.insert(2 * key));  // ascending inserts would make a plain BST a list
+    }
+    CHECK_FALSE(set.insert(500));
+    CHECK(set.size() == 1000);
+
+    std::vector<int> keys;
+    for (auto it = set.begin(); it != set.end(); ++it) {
+        keys.push_back(*it);
+    }
+    CHECK(keys.size() == 1000);
+    CHECK(std::is_sorted(keys.begin(), keys.end()));
+    CHECK(*--set.end() == 1998);
+
+    int height = 0;
+    for (const auto &level : set.get_tree().levels()) {
+        height = static_cast<int>(level.depth()) + 1;
+    }
+    CHECK(height <= 18);  // log_{3/2}(1000) + 1
+
+    CHECK(set.contains(998));
+    CHECK_FALSE(set.contains(999));
+    CHECK(*set.find(40) == 40);
+    CHECK(set.find(41) == set.end());
+    CHECK(*set.lower_bound(41) == 42);
+    CHECK(*set.upper_bound(42) == 44);
+    CHECK(set.lower_bound(2000) == set.end());
+
+    keys.clear();
+    for (int key : set.range(10, 20)) {
+        keys.push_back(key);
+    }
+    CHECK(keys == std::vector<int>{10, 12, 14, 16, 18});
+
+    SearchTree<std::string, std::greater<std::string>> words;
+    for (const char *word : {"pear", "apple", "fig", "kiwi", "banana"}) {
+        words.insert(word);
+    }
+    std::vector<std::string> ordered;
+    for (auto it = words.begin(); it != words.end(); ++it) {
+        ordered.push_back(*it);
+    }
+    CHECK(ordered == std::vector<std::string>{"pear", "kiwi", "fig", "banana", "apple"});
+}
+
+TEST_CASE("SearchTree_copies_do_not_share_nodes") {
+    SearchTree<int> original;
+    for (int key = 0; key < 100; ++key) {
+        original.insert(key);
+    }
+    SearchTree<int> copy = original;
+    for (int key = 100; key < 200; ++key) {
+        copy.insert(key);  // ascending, so the copy is rebuilt several times
+    }
+    CHECK(copy.size() == 200);
+    CHECK(original.size() == 100);
+    CHECK(std::distance(original.begin(), original.end()) == 100);
+    CHECK(*--original.end() == 99);
+    CHECK_FALSE(original.contains(150));
+
+    SearchTree<int> assigned;
+    assigned.insert(-1);
+    assigned = original;
+    assigned.insert(500);
+    CHECK(assigned.size() == 101);
+    CHECK_FALSE(original.contains(500));
+
+    SearchTree<int> moved = std::move(copy);
+    CHECK(moved.size() == 200);
+    CHECK(copy.empty());
+    CHECK(copy.insert(7));
+    CHECK(*copy.begin() == 7);
+
+    static_assert(std::is_same<decltype(*original.begin()), const int &>::value, "Keys must not be modifiable in place.");
+}
+
+TEST_CASE("BTree_stores_keys_in_wide_nodes") {
+    BTree<int, 4> tree;  // at most three keys per node, so even small trees have several levels
+    CHECK(tree.empty());
+    CHECK(tree.begin_in_order() == tree.end_in_order());
+    for (int key = 100; key > 0; --key) {
+        CHECK(tree.insert(key * 3 % 101));  // 3 and 101 are coprime, so every key is distinct
+    }
+    CHECK_FALSE(tree.insert(3));
+    CHECK(tree.size() == 100);
+    CHECK(tree.height() > 2);
+
+    std::vector<int> keys(tree.begin_in_order(), tree.end_in_order());
+    CHECK(keys.size() == 100);
+    CHECK(std::is_sorted(keys.begin(), keys.end()));
+    CHECK(*--tree.end_in_order() == 100);
+
+    std::size_t nodes = 0, stored = 0;
+    for (const auto &node : tree.bfs()) {
+        CHECK(node.size() <= 3);
+        CHECK(std::is_sorted(node.keys(), node.keys() + node.size()));
+        ++nodes;
+        stored += node.size();
+    }
+    CHECK(stored == 100);
+    CHECK(nodes >= 34);
+
+    CHECK(tree.contains(57));
+    CHECK_FALSE(tree.contains(0));
+    CHECK(*tree.find(57) == 57);
+    CHECK(tree.find(101) == tree.end());
+    CHECK(*tree.lower_bound(0) == 1);
+    CHECK(*tree.upper_bound(57) == 58);
+    CHECK(tree.upper_bound(100) == tree.end());
+
+    std::vector<int> ranged;
+    for (int key : tree.range(40, 45)) {
+        ranged.push_back(key);
+    }
+    CHECK(ranged == std::vector<int>{40, 41, 42, 43, 44});
+
+    std::vector<int> reversed;
+    for (auto it = tree.end_in_order(); it != tree.begin_in_order();) {
+        reversed.push_back(*--it);
+    }
+    CHECK(std::equal(reversed.rbegin(), reversed.rend(), keys.begin(), keys.end()));
+
+    CHECK(sizeof(BTree<int, 16>::Node) == BTree<int, 16>::CACHE_LINE);
+
+    BTree<Complex, 8> complexes;  // keys are constructed in place and ordered by magnitude
+    for (int i = 0; i < 20; ++i) {
+        complexes.insert(Complex(i % 7, i % 5));
+    }
+    std::vector<Complex> ordered(complexes.begin(), complexes.end());
+    CHECK(ordered.size() == complexes.size());
+    CHECK(std::is_sorted(ordered.begin(), ordered.end()));
+
+    tree.clear();
+    CHECK(tree.empty());
+    CHECK(tree.get_root() == nullptr);
+}
+
+TEST_CASE("KeySearch_matches_the_binary_search") {
+    std::vector<int> ints(200);
+    for (std::size_t i = 0; i < ints.size(); ++i) {
+        ints[i] = static_cast<int>(i / 3) - 30;  // runs of equal keys, negative and positive
+    }
+    std::vector<unsigned> unsigneds = {0, 1, 5, 5, 0x7fffffffu, 0x80000000u, 0xfffffffeu};
+    std::vector<double> doubles = {-2.5, -1, 0, 0.5, 0.5, 3, 1e300};
+    for (std::size_t size = 0; size <= ints.size(); size += 7) {
+        for (int key : {-31, -30, -1, 0, 7, 36, 100}) {
+            CHECK(KeySearch<int, std::less<int>>::lower_bound(ints.data(), size, key, {}) ==
+                  static_cast<std::size_t>(std::lower_bound(ints.begin(), ints.begin() + static_cast<long>(size), key) - ints.begin()));
+            CHECK(KeySearch<int, std::less<int>>::upper_bound(ints.data(), size, key, {}) ==
+                  static_cast<std::size_t>(std::upper_bound(ints.begin(), ints.begin() + static_cast<long>(size), key) - ints.begin()));
+        }
+    }
+    for (unsigned key : {0u, 5u, 0x80000000u, 0xffffffffu}) {
+        CHECK(KeySearch<unsigned, std::less<unsigned>>::lower_bound(unsigneds.data(), unsigneds.size(), key, {}) ==
+              static_cast<std::size_t>(std::lower_bound(unsigneds.begin(), unsigneds.end(), key) - unsigneds.begin()));
+    }
+    for (double key : {-3.0, 0.5, 2.0, 1e301}) {
+        CHECK(KeySearch<double, std::less<double>>::upper_bound(doubles.data(), doubles.size(), key, {}) ==
+              static_cast<std::size_t>(std::upper_bound(doubles.begin(), doubles.end(), key) - doubles.begin()));
+    }
+    std::vector<std::string> words = {"a", "b", "d"};  // not vectorized: the scalar fallback
+    CHECK_FALSE(KeySearch<std::string, std::less<std::string>>::VECTORIZED);
+    CHECK(KeySearch<std::string, std::less<std::string>>::lower_bound(words.data(), words.size(), "c", {}) == 2);
+
+    BTree<double, 64> wide;
+    for (int i = 0; i < 5000; ++i) {
+        wide.insert((i * 37 % 5000) * 0.5);
+    }
+    CHECK(wide.size() == 5000);
+    CHECK(*wide.lower_bound(100.25) == 100.5);
+    CHECK(*wide.upper_bound(100.5) == 101);
+    CHECK(std::is_sorted(wide.begin(), wide.end()));
+}
+
+TEST_CASE("Complex_keys_heapify_and_sort_by_cached_norms") {
+    std::vector<Complex> values;
+    for (int i = 0; i < 101; ++i) {  // an odd count exercises the scalar tail of the batch
+        values.emplace_back((i * 37) % 23 - 11, (i * 11) % 17 - 8);
+    }
+    std::vector<double> norms(values.size());
+    SortKey<Complex>::compute(values.data(), values.size(), norms.data());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        CHECK(norms[i] == values[i].norm());
+    }
+
+    std::vector<Complex> heap = values;
+    make_min_heap(heap);
+    CHECK(std::is_heap(heap.begin(), heap.end(), std::greater<Complex>()));
+    CHECK(std::is_permutation(heap.begin(), heap.end(), values.begin(), values.end()));
+
+    std::vector<Complex> sorted = values;
+    sort_by_key(sorted);
+    CHECK(std::is_sorted(sorted.begin(), sorted.end()));
+    CHECK(std::is_permutation(sorted.begin(), sorted.end(), values.begin(), values.end()));
+
+    Tree<Complex> tree;
+    tree.add_root(Complex(5, 5));
+    tree.add_sub_node(Complex(5, 5), Complex(3, -3));
+    tree.add_sub_node(Complex(5, 5), Complex(0, 1));
+    tree.add_sub_node(Complex(3, -3), Complex(-2, 0));
+    std::vector<Complex> order;
+    for (const auto &node : tree.heap()) {
+        order.push_back(node->key);
+    }
+    CHECK(order.front() == Complex(0, 1));
+    CHECK(std::is_heap(order.begin(), order.end(), std::greater<Complex>()));
+
+    std::vector<int> ints = {5, 1, 4, 2, 3};  // no SortKey: the plain standard algorithms
+    make_min_heap(ints);
+    CHECK(ints.front() == 1);
+    sort_by_key(ints);
+    CHECK(ints == std::vector<int>{1, 2, 3, 4, 5});
+}
+
+TEST_CASE("CachedComplex_keeps_its_norm_in_sync") {
+    CachedComplex a(3, 4);
+    CHECK(a.norm() == 25);
+    a.setReal(1);
+    CHECK(a.norm() == 17);
+    a.setImaginary(-1);
+    CHECK(a.norm() == 2);
+    CHECK(a.toComplex() == Complex(1, -1));
+    CHECK(CachedComplex(Complex(2, 2)) == CachedComplex(2, 2));
+    CHECK(a.toString() == Complex(1, -1).toString());
+
+    // the ordering agrees with Complex's magnitude ordering
+    std::vector<Complex> plain = {Complex(3, 4), Complex(0, 1), Complex(-5, 0), Complex(2, -2), Complex(0, 0)};
+    for (const Complex &x : plain) {
+        for (const Complex &y : plain) {
+            CachedComplex cx(x), cy(y);
+            CHECK((cx < cy) == (x < y));
+            CHECK((cx > cy) == (x > y));
+            CHECK((cx <= cy) == (x <= y));
+            CHECK((cx >= cy) == (x >= y));
+        }
+    }
+    CHECK(std::hash<CachedComplex>()(CachedComplex(1, 2)) == std::hash<Complex>()(Complex(1, 2)));
+
+    Tree<CachedComplex> tree;
+    tree.add_root(CachedComplex(5, 5));
+    tree.add_sub_node(CachedComplex(5, 5), CachedComplex(3, -3));
+    tree.add_sub_node(CachedComplex(5, 5), CachedComplex(0, 1));
+    tree.add_sub_node(CachedComplex(3, -3), CachedComplex(-2, 0));
+    std::vector<CachedComplex> order;
+    for (const auto &node : tree.heap()) {
+        order.push_back(node->key);
+    }
+    CHECK(order.front() == CachedComplex(0, 1));
+    CHECK(std::is_heap(order.begin(), order.end(), std::greater<CachedComplex>()));
+
+    std::ostringstream out;
+    write_newick(tree, out);
+    std::istringstream in(out.str());
+    Tree<CachedComplex> parsed = parse_newick<CachedComplex>(in);
+    CHECK(parsed.get_root()->key == tree.get_root()->key);
+    CHECK(fromString<CachedComplex>("1.5 - 2i") == CachedComplex(1.5, -2));
+}
+
+TEST_CASE("Complex_is_constexpr_with_arithmetic_and_std_complex_interop") {
+    constexpr Complex a(1, 2);
+    constexpr Complex b(3, -1);
+    static_assert((a + b) == Complex(4, 1), "constexpr addition");
+    static_assert((a - b) == Complex(-2, 3), "constexpr subtraction");
+    static_assert((a * b) == Complex(5, 5), "constexpr multiplication");
+    static_assert((Complex(5, 5) / b) == a, "constexpr division");
+    static_assert(a.conjugate() == Complex(1, -2), "constexpr conjugate");
+    static_assert(-a == Complex(-1, -2), "constexpr negation");
+    static_assert(2.0 * a == Complex(2, 4) && a + 1.0 == Complex(2, 2), "doubles convert to real numbers");
+    static_assert(a.norm() == 5 && a < b, "constexpr ordering");
+    static_assert(std::is_trivially_copyable<Complex>::value, "memcpy-serializable");
+    static_assert(noexcept(a * b) && noexcept(Complex(1, 2)), "noexcept arithmetic");
+
+    Complex c = a;
+    c *= Complex(0, 1);
+    CHECK(c == Complex(-2, 1));
+    c /= Complex(0, 1);
+    CHECK(c == a);
+    CHECK(Complex(3, 4).abs() == 5);
+    CHECK(Complex(0, 2).arg() == doctest::Approx(std::acos(0.0)));
+    CHECK(Complex() == Complex(0, 0));
+
+    std::complex<double> standard(a);
+    CHECK(standard * static_cast<std::complex<double>>(b) == std::complex<double>(5, 5));
+    CHECK(Complex(standard) == a);
+
+    Tree<Complex> tree;
+    tree.add_root(Complex(1, 1));
+    tree.add_sub_node(Complex(1, 1), Complex(2, -3));
+    tree.add_sub_node(Complex(1, 1), Complex(-0.5, 4));
+    Complex sum = std::accumulate(tree.begin_bfs_scan(), tree.end_bfs_scan(), Complex(),
+                                  [](Complex total, const auto &node) { return total + node->key; });
+    CHECK(sum == Complex(2.5, 2));
+}
+
+TEST_CASE("Complex_formats_with_to_chars_in_shortest_form") {
+    char buffer[Complex::MAX_CHARS];
+    char *end = Complex(1.5, -2).toChars(buffer, buffer + sizeof(buffer));
+    CHECK(std::string(buffer, end) == "1.5 - 2i");
+    CHECK(Complex(0.1, 0.2).toString() == "0.1 + 0.2i");
+    CHECK(Complex(-0.0, -0.0).toString() == "-0 - 0i");
+
+    // the longest doubles still fit, and the text reads back to the same value
+    const Complex extreme(-1.7976931348623157e308, -2.2250738585072014e-308);
+    end = extreme.toChars(buffer, buffer + sizeof(buffer));
+    REQUIRE(end != nullptr);
+    CHECK(fromString<Complex>(std::string_view(buffer, static_cast<std::size_t>(end - buffer))) == extreme);
+    CHECK(Complex(1.5, -2).toChars(buffer, buffer + 5) == nullptr);
+
+    std::ostringstream out;
+    out << Complex(3, 4) << ' ' << CachedComplex(0.25, -1);
+    CHECK(out.str() == "3 + 4i 0.25 - 1i");
+}
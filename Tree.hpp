@@ -1,16 +1,41 @@
 //oriyati0701@gmail.com
 
+#ifndef TREESITERATORS_CPP_TREE_HPP
+#define TREESITERATORS_CPP_TREE_HPP
+
 #include <vector>
 #include <memory>
+#include <iterator>
+#include <cstddef>
 #include <queue>
+#include <deque>
+#include <type_traits>
 #include <functional> // For std::greater
 #include <algorithm> // For std::make_heap, std::sort_heap
 #include <stdexcept>
-#include <stack> // Include stack header
+#include <array>
+#include <cstdint>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+#include "TreeStats.hpp"
+#include "TreeTrace.hpp"
+#include "TreeTraversal.hpp"
+#include "TreeGenerator.hpp"
+#include "SortKey.hpp"
 
 /**
  * @brief A templated tree class with D-ary tree structure and various traversal iterators.
  *
+ * Both add_sub_node overloads may be called concurrently from several threads;
+ * traversals, add_root and myHeap must not overlap with writers.
+ *
+ * When compiled with TREE_ENABLE_STATS, the tree counts allocations,
+ * traversals, parent searches and heap rebuilds; see stats(). When compiled
+ * with TREE_ENABLE_TRACING, the bulk builders, traversals and myHeap report
+ * timing spans to the sink installed by set_trace_sink().
+ *
  * @tparam T The type of the elements stored in the tree.
  * @tparam D The degree of the tree, default is 2 (binary tree).
  */
@@ -34,25 +59,185 @@ public:
 
 /**
  * @brief Helper function to convert the tree into a min-heap.
+ *
+ * Keys with a SortKey, such as Complex, are heapified on sort keys
+ * computed once for all of them; see make_min_heap.
  */
 void myHeap() {
+    TraceSpan span("my_heap");
     std::vector<T> values;
-    for (auto it = begin_bfs_scan(); it != end_bfs_scan(); ++it) {
-        values.push_back((*it)->key);
-    }
-    std::make_heap(values.begin(), values.end(), std::greater<T>());
-    root = nullptr;
-    add_root(values.front());
+    visit<BreadthFirst>([&values](const Node &node) { values.push_back(node.key); });
+    span.set_nodes(values.size());
+    make_min_heap(values);
+    counters.rebuilt_heap();
+    release(std::move(root));
 
-    for (unsigned int i = 1; i < values.size(); i++) {
-        add_sub_node(values[(i-1)/2], values[i]);
+    // Link by heap index in one pass instead of a parent search per node.
+    std::vector<std::size_t> parents(values.size());
+    for (std::size_t i = 0; i < values.size(); i++) {
+        parents[i] = i == 0 ? NO_PARENT : (i - 1) / 2;
     }
+    build_from_parent_array(parents, values);
 }
 
 private:
+    /**
+     * @brief Striped lock table guarding the Node::children vectors.
+     *
+     * Every node maps to one stripe by its address, so writers working on
+     * disjoint subtrees rarely contend and Node itself carries no mutex.
+     * The table is created by the first locked access, so trees that are
+     * never written through add_sub_node or searched by value, such as
+     * temporaries, do not pay for it. Copies of a non-empty tree share their
+     * nodes, so they share this table too.
+     */
+    class LockTable {
+    public:
+        static const std::size_t STRIPES = 64;  ///< Number of mutex stripes, a power of two.
+
+        /**
+         * @brief Get the mutex guarding the children of a node.
+         *
+         * @param node The node whose children are about to be read or modified.
+         * @return std::mutex& The stripe the node hashes to.
+         */
+        std::mutex &for_node(const Node *node) {
+            // Fibonacci hashing: the top six bits of the product pick one of the 64 stripes,
+            // which spreads neighbouring allocations evenly.
+            auto bits = static_cast<std::uint64_t>(reinterpret_cast<std::uintptr_t>(node));
+            return stripes[static_cast<std::size_t>((bits * 0x9E3779B97F4A7C15ull) >> 58)].mutex;
+        }
+
+    private:
+        /**
+         * @brief A mutex on a cache line of its own, so that stripes do not false-share.
+         */
+        struct alignas(64) Stripe {
+            std::mutex mutex;
+        };
+
+        std::array<Stripe, STRIPES> stripes;
+    };
+
     std::shared_ptr<Node> root;  ///< The root node of the tree.
+    mutable std::shared_ptr<LockTable> locks;                ///< Per-subtree locks for concurrent inserts, null until first used.
+    mutable std::atomic<LockTable *> lock_cache{nullptr};    ///< locks.get(), published once the table exists.
+    mutable TreeCounters counters;  ///< Operation counters, empty unless TREE_ENABLE_STATS is defined.
+
+    template<typename, typename>
+    friend class SearchTree;  ///< Relinks nodes when it rebalances.
+
+    /**
+     * @brief Get the lock table, creating it on first use.
+     *
+     * Concurrent first calls may each allocate a table; one wins the
+     * compare-exchange and the others discard theirs.
+     *
+     * @return LockTable& The table shared by this tree and its copies.
+     */
+    LockTable &lock_table() const {
+        LockTable *table = lock_cache.load(std::memory_order_acquire);
+        if (table)
+            return *table;
+        auto created = std::make_shared<LockTable>();
+        if (lock_cache.compare_exchange_strong(table, created.get(), std::memory_order_acq_rel, std::memory_order_acquire)) {
+            table = created.get();
+            locks = std::move(created);  // only the winner writes locks
+        }
+        return *table;
+    }
+
+    /**
+     * @brief Share the lock table with a copy; an empty tree has no nodes to guard, so it shares none.
+     */
+    std::shared_ptr<LockTable> shared_locks() const {
+        if (!root)
+            return nullptr;
+        lock_table();
+        return locks;
+    }
+
+    /**
+     * @brief Take over another tree's lock table, leaving it to create a new one when needed.
+     */
+    void take_locks(Tree &other) {
+        locks = std::move(other.locks);
+        lock_cache.store(other.lock_cache.exchange(nullptr, std::memory_order_acq_rel), std::memory_order_release);
+    }
+
+    /**
+     * @brief Destroy the nodes owned only through a given pointer, without recursion.
+     *
+     * Destroying a shared_ptr<Node> chain recursively overflows the stack for
+     * deep trees, so exclusively owned children are detached onto an explicit
+     * stack first. Subtrees still shared with another tree copy are left alone.
+     *
+     * @param node The subtree to release.
+     */
+    static void release(std::shared_ptr<Node> node) {
+        std::vector<std::shared_ptr<Node>> stack;
+        if (node.use_count() == 1)
+            stack.push_back(std::move(node));
+        while (!stack.empty()) {
+            std::shared_ptr<Node> current = std::move(stack.back());
+            stack.pop_back();
+            for (auto &child : current->children) {
+                if (child.use_count() == 1)
+                    stack.push_back(std::move(child));
+            }
+        }
+    }
 
 public:
+    /**
+     * @brief Construct an empty tree.
+     */
+    Tree() = default;
+
+    /**
+     * @brief Copy a tree; the copy shares its nodes, and so its lock table, with the original.
+     */
+    Tree(const Tree &other) : root(other.root), locks(other.shared_locks()), lock_cache(locks.get()), counters(other.counters) {}
+
+    /**
+     * @brief Move a tree, leaving the source empty but usable.
+     */
+    Tree(Tree &&other) noexcept : root(std::move(other.root)) {
+        take_locks(other);
+    }
+
+    /**
+     * @brief Copy-assign a tree; the copy shares its nodes with the original.
+     */
+    Tree &operator=(const Tree &other) {
+        if (this != &other) {
+            release(std::move(root));
+            root = other.root;
+            locks = other.shared_locks();
+            lock_cache.store(locks.get(), std::memory_order_release);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Move-assign a tree, leaving the source empty but usable.
+     */
+    Tree &operator=(Tree &&other) {
+        if (this != &other) {
+            release(std::move(root));
+            root = std::move(other.root);
+            take_locks(other);
+        }
+        return *this;
+    }
+
+    /**
+     * @brief Destroy the tree iteratively, so deep trees do not overflow the stack.
+     */
+    ~Tree() {
+        release(std::move(root));
+    }
+
     /**
      * @brief Get the root node.
      *
@@ -62,6 +247,31 @@ public:
         return root.get();
     }
 
+    /**
+     * @brief Get the root node of a const tree.
+     *
+     * @return const Node* Pointer to the root node.
+     */
+    const Node* get_root() const {
+        return root.get();
+    }
+
+    /**
+     * @brief Get a snapshot of the operation counters.
+     *
+     * @return TreeStats The counters; all zero unless compiled with TREE_ENABLE_STATS.
+     */
+    TreeStats stats() const {
+        return counters.snapshot();
+    }
+
+    /**
+     * @brief Set the operation counters back to zero.
+     */
+    void reset_stats() {
+        counters.reset();
+    }
+
     /**
      * @brief Add a root node to the tree.
      *
@@ -73,331 +283,712 @@ public:
             throw std::invalid_argument("Root already exists.");
         }
         root = std::make_shared<Node>(key);
+        counters.allocated(1);
     }
 
+    /**
+     * @brief Parent index that marks the root in build_from_parent_array.
+     */
+    static constexpr std::size_t NO_PARENT = static_cast<std::size_t>(-1);
+
+    /**
+     * @brief Maximum depth that does not limit a pruned traversal.
+     */
+    static constexpr std::size_t NO_DEPTH_LIMIT = static_cast<std::size_t>(-1);
+
     /**
      * @brief Add a sub node to a parent node identified by its value.
      *
+     * The parent is searched in breadth-first order. Safe to call from several
+     * threads at once: each node's children are read and extended under that
+     * node's lock stripe only, never under a tree-wide lock.
+     *
      * @param parent The value of the parent node.
      * @param key The value to be stored in the new sub node.
      * @throws std::logic_error If the parent node is not found.
      */
     void add_sub_node(T parent, T key) {
-        for (auto it = begin_bfs_scan(); it != end_bfs_scan(); ++it) {
-            if ((*it)->key == parent) {
-                (*it)->children.push_back(std::make_shared<Node>(key));
-                return;
-            }
+        add_sub_node(find_parent(parent), key);
+    }
+
+    /**
+     * @brief Add a sub node directly under a known parent node.
+     *
+     * Runs in O(1) without searching the tree. Threads inserting under
+     * different parents only contend when the parents share a lock stripe.
+     *
+     * @param parent Pointer to the parent node, e.g. from get_root() or a previous call.
+     * @param key The value to be stored in the new sub node.
+     * @return Node* Pointer to the newly added node.
+     * @throws std::invalid_argument If the parent is null.
+     */
+    Node* add_sub_node(Node *parent, T key) {
+        if (!parent) {
+            throw std::invalid_argument("Parent is null.");
         }
-        throw std::logic_error("Parent not found.");
+        auto child = std::make_shared<Node>(key);  // allocate outside the critical section
+        counters.allocated(1);
+        Node *added = child.get();
+        std::lock_guard<std::mutex> guard(lock_table().for_node(parent));
+        parent->children.push_back(std::move(child));
+        return added;
     }
 
     /**
-     * @brief Base class for different types of tree iterators.
+     * @brief Add several sub nodes under one parent identified by its value.
+     *
+     * The parent is searched once, instead of once per key as with repeated add_sub_node calls.
+     *
+     * @tparam InputIt An input iterator over values convertible to T.
+     * @param parent The value of the parent node.
+     * @param first The first key to add.
+     * @param last One past the last key to add.
+     * @throws std::logic_error If the parent node is not found.
      */
-    class Iterator {
-    protected:
-        std::vector<std::shared_ptr<Node>> nodes;  ///< Vector of nodes to iterate over.
+    template<typename InputIt>
+    void add_sub_nodes(T parent, InputIt first, InputIt last) {
+        add_sub_nodes(find_parent(parent), first, last);
+    }
 
-    public:
-        /**
-         * @brief Advance the iterator to the next element.
-         *
-         * @return Iterator& Reference to the current iterator.
-         */
-        virtual Iterator &operator++() {
-            if (!nodes.empty()) {
-                nodes.erase(nodes.begin());
-            }
-            return *this;
+    /**
+     * @brief Add several sub nodes under a known parent node.
+     *
+     * The new nodes are allocated outside the lock, then the parent's children
+     * are reserved once and extended in a single critical section.
+     *
+     * @tparam InputIt An input iterator over values convertible to T.
+     * @param parent Pointer to the parent node.
+     * @param first The first key to add.
+     * @param last One past the last key to add.
+     * @throws std::invalid_argument If the parent is null.
+     */
+    template<typename InputIt>
+    void add_sub_nodes(Node *parent, InputIt first, InputIt last) {
+        if (!parent) {
+            throw std::invalid_argument("Parent is null.");
+        }
+        std::vector<std::shared_ptr<Node>> added;
+        for (; first != last; ++first) {
+            added.push_back(std::make_shared<Node>(*first));
+        }
+        counters.allocated(added.size());
+        std::lock_guard<std::mutex> guard(lock_table().for_node(parent));
+        parent->children.reserve(parent->children.size() + added.size());
+        for (auto &child : added) {
+            parent->children.push_back(std::move(child));
         }
+    }
 
-        /**
-         * @brief Check if two iterators are not equal.
-         *
-         * @param other Another iterator to compare with.
-         * @return true If the iterators are not equal.
-         * @return false If the iterators are equal.
-         */
-        virtual bool operator!=(const Iterator &other) const {
-            return !nodes.empty() || !other.nodes.empty();
+    /**
+     * @brief Build the whole tree from a parent index array in linear time.
+     *
+     * Node i holds keys[i] and hangs under node parents[i]; exactly one entry
+     * must be NO_PARENT and becomes the root. Siblings keep their index order.
+     * Every child vector is reserved once, so no node search or reallocation happens.
+     *
+     * @param parents The parent index of every node.
+     * @param keys The value of every node.
+     * @throws std::invalid_argument If the root already exists, the sizes differ or there is not exactly one root.
+     * @throws std::logic_error If a parent index is out of range or the parents form a cycle.
+     */
+    void build_from_parent_array(const std::vector<std::size_t> &parents, const std::vector<T> &keys) {
+        if (root) {
+            throw std::invalid_argument("Root already exists.");
         }
+        if (parents.size() != keys.size()) {
+            throw std::invalid_argument("Parent and key counts differ.");
+        }
+        if (keys.empty()) {
+            return;
+        }
+        TraceSpan span("build_from_parent_array", keys.size());
+        std::size_t root_index = check_parent_array(parents);
 
-        /**
-         * @brief Dereference the iterator to get the current node.
-         *
-         * @return std::shared_ptr<Node> The current node.
-         */
-        std::shared_ptr<Node> operator*() const {
-            return nodes.front();
+        std::vector<std::size_t> child_counts(keys.size(), 0);
+        for (std::size_t i = 0; i < parents.size(); ++i) {
+            if (i != root_index)
+                ++child_counts[parents[i]];
         }
-    };
+        std::vector<std::shared_ptr<Node>> nodes;
+        std::vector<Node *> raw;
+        nodes.reserve(keys.size());
+        raw.reserve(keys.size());
+        for (std::size_t i = 0; i < keys.size(); ++i) {
+            nodes.push_back(std::make_shared<Node>(keys[i]));
+            nodes.back()->children.reserve(child_counts[i]);
+            raw.push_back(nodes.back().get());
+        }
+        counters.allocated(keys.size());
+        for (std::size_t i = 0; i < parents.size(); ++i) {
+            if (i != root_index)
+                raw[parents[i]]->children.push_back(std::move(nodes[i]));
+        }
+        root = std::move(nodes[root_index]);
+    }
 
     /**
-     * @brief Iterator for pre-order traversal.
+     * @brief Build the whole tree from a range of (parent, child) key pairs.
+     *
+     * The parent of the first edge becomes the root; every other parent must
+     * appear as a child of an earlier edge. Keys are resolved through a hash
+     * map to the first node created with that value, so T needs std::hash.
+     *
+     * @tparam EdgeRange A range of std::pair-like elements with first (parent) and second (child).
+     * @param edges The edges in parent-before-child order.
+     * @throws std::invalid_argument If the root already exists.
+     * @throws std::logic_error If a parent has not been added by an earlier edge.
      */
-    class PreOrderIterator : public Iterator {
-    public:
-        /**
-         * @brief Construct a new PreOrderIterator object.
-         *
-         * @param root The root node to start the traversal from.
-         */
-        PreOrderIterator(std::shared_ptr<Node> root) {
-            if (root)
-                preorder(root);
+    template<typename EdgeRange>
+    void build_from_edges(const EdgeRange &edges) {
+        if (root) {
+            throw std::invalid_argument("Root already exists.");
         }
-
-    private:
-        /**
-         * @brief Helper function to perform pre-order traversal.
-         *
-         * @param node The current node in the traversal.
-         */
-        void preorder(std::shared_ptr<Node> node) {
-            this->nodes.push_back(node);
-            for (auto child : node->children) {
-                preorder(child);
+        TraceSpan span("build_from_edges");
+        std::vector<std::size_t> parents;
+        std::vector<T> keys;
+        std::unordered_map<T, std::size_t> index;
+        for (const auto &edge : edges) {
+            std::size_t parent;
+            auto found = index.find(edge.first);
+            if (found != index.end()) {
+                parent = found->second;
+            } else if (keys.empty()) {
+                parent = 0;
+                index.emplace(edge.first, 0);
+                keys.push_back(edge.first);
+                parents.push_back(NO_PARENT);
+            } else {
+                throw std::logic_error("Parent not found.");
             }
+            index.emplace(edge.second, keys.size());
+            keys.push_back(edge.second);
+            parents.push_back(parent);
         }
-    };
+        span.set_nodes(keys.size());
+        build_from_parent_array(parents, keys);
+    }
 
+private:
     /**
-     * @brief Get an iterator to the beginning of the pre-order traversal.
+     * @brief Find the first node holding a value, in breadth-first order.
      *
-     * @return PreOrderIterator The beginning iterator.
+     * Each node's children are read under its lock stripe, so the search is
+     * safe while other threads insert.
+     *
+     * @param parent The value to look for.
+     * @return Node* The matching node.
+     * @throws std::logic_error If no node holds the value.
      */
-    PreOrderIterator begin_pre_order() const {
-        return PreOrderIterator(root);
+    Node *find_parent(const T &parent) {
+        std::queue<Node *> queue;
+        std::uint64_t examined = 0;
+        if (root)
+            queue.push(root.get());
+        while (!queue.empty()) {
+            Node *node = queue.front();
+            queue.pop();
+            ++examined;
+            if (node->key == parent) {
+                counters.searched(examined);
+                return node;
+            }
+            std::lock_guard<std::mutex> guard(lock_table().for_node(node));
+            for (auto &child : node->children) {
+                queue.push(child.get());
+            }
+        }
+        counters.searched(examined);
+        throw std::logic_error("Parent not found.");
     }
 
     /**
-     * @brief Get an iterator to the end of the pre-order traversal.
+     * @brief Validate a parent index array before any node is linked.
      *
-     * @return PreOrderIterator The end iterator.
+     * Walks every node up towards the root once, so the check is linear.
+     *
+     * @param parents The parent index of every node.
+     * @return std::size_t The index of the single root.
+     * @throws std::invalid_argument If there is not exactly one root.
+     * @throws std::logic_error If a parent index is out of range or the parents form a cycle.
      */
-    PreOrderIterator end_pre_order() const {
-        return PreOrderIterator(nullptr);
+    static std::size_t check_parent_array(const std::vector<std::size_t> &parents) {
+        std::size_t root_index = NO_PARENT;
+        for (std::size_t i = 0; i < parents.size(); ++i) {
+            if (parents[i] == NO_PARENT) {
+                if (root_index != NO_PARENT) {
+                    throw std::invalid_argument("More than one root.");
+                }
+                root_index = i;
+            } else if (parents[i] >= parents.size()) {
+                throw std::logic_error("Parent not found.");
+            }
+        }
+        if (root_index == NO_PARENT) {
+            throw std::invalid_argument("No root in parent array.");
+        }
+
+        enum : char { UNSEEN, ON_PATH, ROOTED };
+        std::vector<char> state(parents.size(), UNSEEN);
+        state[root_index] = ROOTED;
+        for (std::size_t i = 0; i < parents.size(); ++i) {
+            std::size_t node = i;
+            while (state[node] == UNSEEN) {
+                state[node] = ON_PATH;
+                node = parents[node];
+            }
+            if (state[node] == ON_PATH) {
+                throw std::logic_error("Parent array contains a cycle.");
+            }
+            for (node = i; state[node] == ON_PATH; node = parents[node]) {
+                state[node] = ROOTED;
+            }
+        }
+        return root_index;
     }
 
+private:
     /**
-     * @brief Iterator for post-order traversal.
+     * @brief Reports the progress of one iterator traversal to the stats counters and trace span.
+     *
+     * Holds nothing unless TREE_ENABLE_STATS or TREE_ENABLE_TRACING is
+     * defined. Copies of an iterator share the span, which ends when the last
+     * copy is destroyed; they may advance on different threads.
      */
-    class PostOrderIterator : public Iterator {
+    class TraversalProbe {
     public:
+        TraversalProbe() = default;
+
         /**
-         * @brief Construct a new PostOrderIterator object.
+         * @brief Count a started traversal and open its span if a trace sink is installed.
          *
-         * @param root The root node to start the traversal from.
+         * @param counters The counters of the traversed tree.
+         * @param name The span name.
          */
-        PostOrderIterator(std::shared_ptr<Node> root) {
-            if (root)
-                postorder(root);
+        TraversalProbe(TreeCounters &counters, const char *name) {
+            counters.traversal_started();
+#ifdef TREE_ENABLE_STATS
+            this->counters = &counters;
+#endif
+#ifdef TREE_ENABLE_TRACING
+            if (trace_sink_slot().load(std::memory_order_acquire))
+                span = std::make_shared<TraceSpan>(name);
+#endif
+            (void) name;
         }
 
-    private:
         /**
-         * @brief Helper function to perform post-order traversal.
+         * @brief Count nodes produced by the traversal.
          *
-         * @param node The current node in the traversal.
+         * @param pending The stack frames or queued nodes the traversal holds.
+         * @param nodes The number of nodes produced, one except for whole levels.
          */
-        void postorder(std::shared_ptr<Node> node) {
-            for (auto child : node->children) {
-                postorder(child);
+        void visited(std::size_t pending, std::size_t nodes = 1) {
+#ifdef TREE_ENABLE_STATS
+            if (counters) {
+                counters->visited(nodes);
+                counters->buffered(pending);
             }
-            this->nodes.push_back(node);
+#endif
+#ifdef TREE_ENABLE_TRACING
+            if (span)
+                span->add_nodes(nodes);
+#endif
+            (void) pending;
+            (void) nodes;
         }
+
+    private:
+#ifdef TREE_ENABLE_STATS
+        TreeCounters *counters = nullptr;
+#endif
+#ifdef TREE_ENABLE_TRACING
+        std::shared_ptr<TraceSpan> span;
+#endif
     };
 
+public:
     /**
-     * @brief Get an iterator to the beginning of the post-order traversal.
+     * @brief Lazy iterator over one traversal order.
      *
-     * @return PostOrderIterator The beginning iterator.
-     */
-    PostOrderIterator begin_post_order() const {
-        return PostOrderIterator(root);
-    }
-
-    /**
-     * @brief Get an iterator to the end of the post-order traversal.
+     * Built on the cursors of TreeTraversal.hpp: the iterator only holds the
+     * cursor's stack or queue, so beginning a traversal is O(1), every step is
+     * amortized O(1) and no call is virtual. Modifying the tree invalidates it.
      *
-     * @return PostOrderIterator The end iterator.
-     */
-    PostOrderIterator end_post_order() const {
-        return PostOrderIterator(nullptr);
-    }
-
-    /**
-     * @brief Iterator for in-order traversal.
+     * A standard forward iterator over the shared_ptrs owning the nodes, so it
+     * works with <algorithm> and the parallel algorithms; copies advance
+     * independently.
+     *
+     * @tparam Order An order tag from TreeTraversal.hpp.
      */
-    class InOrderIterator : public Iterator {
+    template<typename Order>
+    class Iterator {
     public:
+        using iterator_category = typename CursorCategory<TraversalCursor<Node, Order, D>>::type;  ///< Bidirectional for in-order.
+        using value_type = std::shared_ptr<Node>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const std::shared_ptr<Node> *;
+        using reference = const std::shared_ptr<Node> &;
+
+        /**
+         * @brief Construct the end iterator.
+         */
+        Iterator() = default;
+
         /**
-         * @brief Construct a new InOrderIterator object.
+         * @brief Start a traversal.
          *
-         * @param root The root node to start the traversal from.
+         * @param root Pointer to the shared_ptr owning the root.
+         * @param probe Receives the traversal's progress.
+         * @param policies Further cursor arguments, e.g. the Pruning of a Pruned order.
          */
-        InOrderIterator(std::shared_ptr<Node> root) {
-            if (root)
-                inorder(root);
+        template<typename... Policies>
+        Iterator(const std::shared_ptr<Node> *root, TraversalProbe probe, Policies &&... policies)
+            : cursor(root, std::forward<Policies>(policies)...), probe(std::move(probe)) {
+            if (cursor.current())
+                this->probe.visited(cursor.pending());
         }
 
-    private:
         /**
-         * @brief Helper function to perform in-order traversal.
+         * @brief Advance the iterator to the next element.
          *
-         * @param node The current node in the traversal.
+         * @return Iterator& Reference to the current iterator.
          */
-        void inorder(std::shared_ptr<Node> node) {
-            if (D == 2) {
-                inorder_binary(node);
-            } else {
-                dfs(node);
-            }
+        Iterator &operator++() {
+            cursor.advance();
+            if (cursor.current())
+                probe.visited(cursor.pending());
+            return *this;
         }
 
         /**
-         * @brief Helper function to perform in-order traversal for binary trees.
+         * @brief Advance the iterator, returning its previous position.
          *
-         * @param node The current node in the traversal.
+         * @return Iterator A copy made before advancing.
          */
-        void inorder_binary(std::shared_ptr<Node> node) {
-            if (node->children.size() > 0) {
-                inorder_binary(node->children[0]); // left child
-            }
-            this->nodes.push_back(node); // current node
-            if (node->children.size() > 1) {
-                inorder_binary(node->children[1]); // right child
-            }
+        Iterator operator++(int) {
+            Iterator previous = *this;
+            ++*this;
+            return previous;
         }
 
         /**
-         * @brief Helper function to perform depth-first traversal for non-binary trees.
+         * @brief Move the iterator to the previous element; only for bidirectional orders such as in-order.
          *
-         * @param node The current node in the traversal.
+         * @return Iterator& Reference to the current iterator.
          */
-        void dfs(std::shared_ptr<Node> node) {
-            this->nodes.push_back(node);
-            for (auto child : node->children) {
-                dfs(child);
-            }
+        Iterator &operator--() {
+            cursor.retreat();
+            if (cursor.current())
+                probe.visited(cursor.pending());
+            return *this;
         }
-    };
 
-    /**
-     * @brief Get an iterator to the beginning of the in-order traversal.
-     *
-     * @return InOrderIterator The beginning iterator.
-     */
-    InOrderIterator begin_in_order() const {
-        return InOrderIterator(root);
-    }
+        /**
+         * @brief Move the iterator back, returning its previous position.
+         *
+         * @return Iterator A copy made before moving.
+         */
+        Iterator operator--(int) {
+            Iterator previous = *this;
+            --*this;
+            return previous;
+        }
 
-    /**
-     * @brief Get an iterator to the end of the in-order traversal.
-     *
-     * @return InOrderIterator The end iterator.
-     */
-    InOrderIterator end_in_order() const {
-        return InOrderIterator(nullptr);
-    }
+        /**
+         * @brief Check if two iterators are at the same node, or both at the end.
+         *
+         * @param other Another iterator to compare with.
+         * @return true If the iterators are equal.
+         * @return false If the iterators are at different nodes.
+         */
+        bool operator==(const Iterator &other) const {
+            return cursor.current() == other.cursor.current();
+        }
 
-    /**
-     * @brief Iterator for breadth-first traversal.
-     */
-    class BFSIterator : public Iterator {
-    public:
         /**
-         * @brief Construct a new BFSIterator object.
+         * @brief Check if two iterators are not equal.
          *
-         * @param root The root node to start the traversal from.
+         * @param other Another iterator to compare with.
+         * @return true If the iterators are at different nodes.
+         * @return false If the iterators are at the same node or both at the end.
          */
-        BFSIterator(std::shared_ptr<Node> root) {
-            if (root)
-                bfs(root);
+        bool operator!=(const Iterator &other) const {
+            return cursor.current() != other.cursor.current();
         }
 
-    private:
         /**
-         * @brief Helper function to perform breadth-first traversal.
+         * @brief Dereference the iterator to get the current node.
          *
-         * @param root The current node in the traversal.
+         * @return reference The shared_ptr owning the current node, as stored in the tree.
          */
-        void bfs(std::shared_ptr<Node> root) {
-            std::queue<std::shared_ptr<Node>> queue;
-            queue.push(root);
-            while (!queue.empty()) {
-                auto node = queue.front();
-                queue.pop();
-                this->nodes.push_back(node);
-                for (auto &child : node->children) {
-                    queue.push(child);
-                }
-            }
+        reference operator*() const {
+            return *cursor.current();
         }
-    };
 
-    /**
-     * @brief Get an iterator to the beginning of the breadth-first traversal.
-     *
-     * @return BFSIterator The beginning iterator.
-     */
-    BFSIterator begin_bfs_scan() const {
-        return BFSIterator(root);
-    }
+        /**
+         * @brief Access the shared_ptr owning the current node.
+         *
+         * @return pointer Pointer to that shared_ptr.
+         */
+        pointer operator->() const {
+            return cursor.current();
+        }
 
-    /**
-     * @brief Get an iterator to the end of the breadth-first traversal.
-     *
-     * @return BFSIterator The end iterator.
-     */
-    BFSIterator end_bfs_scan() const {
-        return BFSIterator(nullptr);
-    }
+    private:
+        TraversalCursor<Node, Order, D> cursor;  ///< Position in the traversal.
+        TraversalProbe probe;                    ///< Stats and tracing hooks.
+    };
+
+    using PreOrderIterator = Iterator<PreOrder>;       ///< Iterator for pre-order traversal.
+    using PostOrderIterator = Iterator<PostOrder>;     ///< Iterator for post-order traversal.
+    using InOrderIterator = Iterator<InOrder>;         ///< Bidirectional iterator for in-order traversal.
+    using BFSIterator = Iterator<BreadthFirst>;        ///< Iterator for breadth-first traversal.
+    using DFSIterator = Iterator<DepthFirst>;          ///< Iterator for depth-first traversal.
+    using HeapIterator = Iterator<BreadthFirst>;       ///< Iterator for heap traversal, breadth-first after myHeap.
+    using ReversePreOrderIterator = Iterator<ReversePreOrder>;    ///< Iterator for pre-order from the last node back.
+    using ReversePostOrderIterator = Iterator<ReversePostOrder>;  ///< Iterator for post-order from the last node back.
+    using ReverseBFSIterator = Iterator<ReverseBreadthFirst>;     ///< Iterator for breadth-first order from the last node back.
+    template<typename Skip>
+    using PrunedDFSIterator = Iterator<Pruned<DepthFirst, Skip>>;    ///< Depth-first with a depth limit and skipped subtrees.
+    template<typename Skip>
+    using PrunedBFSIterator = Iterator<Pruned<BreadthFirst, Skip>>;  ///< Breadth-first with a depth limit and skipped subtrees.
 
     /**
-     * @brief Iterator for depth-first traversal.
+     * @brief Lazy breadth-first iterator that yields one whole level per step.
+     *
+     * Dereferencing gives a TreeLevel: the depth and a contiguous array of the
+     * level's nodes, valid until the iterator advances. Modifying the tree
+     * invalidates it.
      */
-    class DFSIterator : public Iterator {
+    class LevelIterator {
     public:
+        using iterator_category = std::input_iterator_tag;     ///< Levels are returned by value.
+        using iterator_concept = std::forward_iterator_tag;    ///< Multi-pass, which C++20 ranges accept.
+        using value_type = TreeLevel<Node>;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = TreeLevel<Node>;
+
         /**
-         * @brief Construct a new DFSIterator object.
+         * @brief Construct the end iterator.
+         */
+        LevelIterator() = default;
+
+        /**
+         * @brief Start a traversal.
          *
-         * @param root The root node to start the traversal from.
+         * @param root Pointer to the shared_ptr owning the root.
+         * @param probe Receives the traversal's progress.
          */
-        DFSIterator(std::shared_ptr<Node> root) {
-            if (root)
-                dfs(root);
+        LevelIterator(const std::shared_ptr<Node> *root, TraversalProbe probe) : cursor(root), probe(std::move(probe)) {
+            if (!cursor.done())
+                this->probe.visited(cursor.pending(), cursor.pending());
         }
 
-    private:
         /**
-         * @brief Helper function to perform depth-first traversal.
+         * @brief Advance the iterator to the next level.
          *
-         * @param root The current node in the traversal.
+         * @return LevelIterator& Reference to the current iterator.
          */
-        void dfs(std::shared_ptr<Node> root) {
-            std::stack<std::shared_ptr<Node>> stack;
-            stack.push(root);
-            while (!stack.empty()) {
-                auto node = stack.top();
-                stack.pop();
-                this->nodes.push_back(node);
-                // Push children in reverse order to maintain the correct order
-                for (auto it = node->children.rbegin(); it != node->children.rend(); ++it) {
-                    stack.push(*it);
-                }
-            }
+        LevelIterator &operator++() {
+            cursor.advance();
+            if (!cursor.done())
+                probe.visited(cursor.pending(), cursor.pending());
+            return *this;
+        }
+
+        /**
+         * @brief Advance the iterator, returning its previous position.
+         *
+         * @return LevelIterator A copy made before advancing.
+         */
+        LevelIterator operator++(int) {
+            LevelIterator previous = *this;
+            ++*this;
+            return previous;
+        }
+
+        /**
+         * @brief Check if two iterators are at the same depth, or both at the end.
+         *
+         * @param other Another iterator to compare with.
+         * @return true If the iterators are equal.
+         * @return false If the iterators are at different levels.
+         */
+        bool operator==(const LevelIterator &other) const {
+            return cursor.done() == other.cursor.done() && cursor.current().depth() == other.cursor.current().depth();
         }
+
+        /**
+         * @brief Check if two iterators are not equal.
+         *
+         * @param other Another iterator to compare with.
+         * @return true If the iterators are at different levels.
+         * @return false If the iterators are at the same level or both at the end.
+         */
+        bool operator!=(const LevelIterator &other) const {
+            return !(*this == other);
+        }
+
+        /**
+         * @brief Get the current level.
+         *
+         * @return TreeLevel<Node> The depth and nodes of the level.
+         */
+        reference operator*() const {
+            return cursor.current();
+        }
+
+    private:
+        LevelCursor<Node> cursor;  ///< The current and next level.
+        TraversalProbe probe;      ///< Stats and tracing hooks.
     };
 
+    /**
+     * @brief Call a visitor on every node in a given order.
+     *
+     * The visitor is called directly from the traversal loop, so it can be
+     * inlined; prefer this over the iterators in tight loops.
+     *
+     * @tparam Order An order tag from TreeTraversal.hpp, e.g. PreOrder or ReverseBreadthFirst.
+     * @tparam Visitor Callable as visitor(Node &node).
+     * @param visitor Called once per node.
+     */
+    template<typename Order, typename Visitor>
+    void visit(Visitor &&visitor) {
+        walk<Order>(visitor);
+    }
+
+    /**
+     * @brief Call a visitor on every node of a const tree in a given order.
+     *
+     * @tparam Order An order tag from TreeTraversal.hpp, e.g. PreOrder or ReverseBreadthFirst.
+     * @tparam Visitor Callable as visitor(const Node &node).
+     * @param visitor Called once per node.
+     */
+    template<typename Order, typename Visitor>
+    void visit(Visitor &&visitor) const {
+        walk<Order>([&visitor](const Node &node) { visitor(node); });
+    }
+
+private:
+    /**
+     * @brief The traversal loop behind visit().
+     */
+    template<typename Order, typename Visitor>
+    void walk(Visitor &&visitor) const {
+        TraceSpan span(OrderTraits<Order, D>::NAME);
+        counters.traversal_started();
+        TraversalCursor<Node, Order, D> cursor(&root);
+        std::size_t count = 0;
+        std::size_t peak = 0;
+        while (const std::shared_ptr<Node> *node = cursor.current()) {
+            ++count;
+            peak = std::max(peak, cursor.pending());
+            visitor(**node);
+            cursor.advance();
+        }
+        counters.visited(count);
+        counters.buffered(peak);
+        span.set_nodes(count);
+    }
+
+    /**
+     * @brief Begin an iterator traversal from the root.
+     *
+     * @tparam Order The order tag.
+     * @param name The span name of the traversal.
+     * @return Iterator<Order> The iterator at the first node.
+     */
+    template<typename Order>
+    Iterator<Order> start(const char *name) const {
+        return Iterator<Order>(&root, TraversalProbe(counters, name));
+    }
+
+public:
+    /**
+     * @brief Get an iterator to the beginning of the pre-order traversal.
+     *
+     * @return PreOrderIterator The beginning iterator.
+     */
+    PreOrderIterator begin_pre_order() const {
+        return start<PreOrder>("traverse_pre_order");
+    }
+
+    /**
+     * @brief Get an iterator to the end of the pre-order traversal.
+     *
+     * @return PreOrderIterator The end iterator.
+     */
+    PreOrderIterator end_pre_order() const {
+        return PreOrderIterator();
+    }
+
+    /**
+     * @brief Get an iterator to the beginning of the post-order traversal.
+     *
+     * @return PostOrderIterator The beginning iterator.
+     */
+    PostOrderIterator begin_post_order() const {
+        return start<PostOrder>("traverse_post_order");
+    }
+
+    /**
+     * @brief Get an iterator to the end of the post-order traversal.
+     *
+     * @return PostOrderIterator The end iterator.
+     */
+    PostOrderIterator end_post_order() const {
+        return PostOrderIterator();
+    }
+
+    /**
+     * @brief Get an iterator to the beginning of the in-order traversal.
+     *
+     * A node with k children is visited after the subtrees of its first
+     * ceil(k/2) children and before those of the rest, so binary trees visit
+     * left child, node, right child; in_order<Split>() picks another split.
+     *
+     * @return InOrderIterator The beginning iterator.
+     */
+    InOrderIterator begin_in_order() const {
+        return start<InOrder>("traverse_in_order");
+    }
+
+    /**
+     * @brief Get an iterator to the end of the in-order traversal.
+     *
+     * @return InOrderIterator The end iterator.
+     */
+    InOrderIterator end_in_order() const {
+        return InOrderIterator(&root, TraversalProbe(), PastEnd());  // knows the root, so it can be decremented
+    }
+
+    /**
+     * @brief Get an iterator to the beginning of the breadth-first traversal.
+     *
+     * @return BFSIterator The beginning iterator.
+     */
+    BFSIterator begin_bfs_scan() const {
+        return start<BreadthFirst>("traverse_bfs_scan");
+    }
+
+    /**
+     * @brief Get an iterator to the end of the breadth-first traversal.
+     *
+     * @return BFSIterator The end iterator.
+     */
+    BFSIterator end_bfs_scan() const {
+        return BFSIterator();
+    }
+
     /**
      * @brief Get an iterator to the beginning of the depth-first traversal.
      *
      * @return DFSIterator The beginning iterator.
      */
     DFSIterator begin_dfs_scan() const {
-        return DFSIterator(root);
+        return start<DepthFirst>("traverse_dfs_scan");
     }
 
     /**
@@ -406,43 +997,68 @@ public:
      * @return DFSIterator The end iterator.
      */
     DFSIterator end_dfs_scan() const {
-        return DFSIterator(nullptr);
+        return DFSIterator();
     }
 
     /**
-     * @brief Iterator for heap traversal.
+     * @brief Get an iterator to the beginning of the reverse pre-order traversal, at the last pre-order node.
+     *
+     * Walks the tree mirrored with an explicit stack, like the forward
+     * orders, so nothing is materialized.
+     *
+     * @return ReversePreOrderIterator The beginning iterator.
      */
-    class HeapIterator : public Iterator {
-    public:
-        /**
-         * @brief Construct a new HeapIterator object.
-         *
-         * @param root The root node to start the traversal from.
-         */
-        HeapIterator(std::shared_ptr<Node> root) {
-            if (root)
-                bfs(root);
-        }
+    ReversePreOrderIterator begin_reverse_pre_order() const {
+        return start<ReversePreOrder>(OrderTraits<ReversePreOrder, D>::NAME);
+    }
 
-    private:
-        /**
-         * @brief Helper function to perform breadth-first traversal for heap conversion.
-         *
-         * @param root The current node in the traversal.
-         */
-        void bfs(std::shared_ptr<Node> root) {
-            std::queue<std::shared_ptr<Node>> queue;
-            queue.push(root);
-            while (!queue.empty()) {
-                auto node = queue.front();
-                queue.pop();
-                this->nodes.push_back(node);
-                for (auto &child : node->children) {
-                    queue.push(child);
-                }
-            }
-        }
-    };
+    /**
+     * @brief Get an iterator to the end of the reverse pre-order traversal.
+     *
+     * @return ReversePreOrderIterator The end iterator.
+     */
+    ReversePreOrderIterator end_reverse_pre_order() const {
+        return ReversePreOrderIterator();
+    }
+
+    /**
+     * @brief Get an iterator to the beginning of the reverse post-order traversal, at the root.
+     *
+     * @return ReversePostOrderIterator The beginning iterator.
+     */
+    ReversePostOrderIterator begin_reverse_post_order() const {
+        return start<ReversePostOrder>(OrderTraits<ReversePostOrder, D>::NAME);
+    }
+
+    /**
+     * @brief Get an iterator to the end of the reverse post-order traversal.
+     *
+     * @return ReversePostOrderIterator The end iterator.
+     */
+    ReversePostOrderIterator end_reverse_post_order() const {
+        return ReversePostOrderIterator();
+    }
+
+    /**
+     * @brief Get an iterator to the beginning of the reverse breadth-first traversal, at the last node.
+     *
+     * The deepest level must come first, so beginning records one pointer
+     * per node; the nodes themselves are not copied.
+     *
+     * @return ReverseBFSIterator The beginning iterator.
+     */
+    ReverseBFSIterator begin_reverse_bfs_scan() const {
+        return start<ReverseBreadthFirst>(OrderTraits<ReverseBreadthFirst, D>::NAME);
+    }
+
+    /**
+     * @brief Get an iterator to the end of the reverse breadth-first traversal.
+     *
+     * @return ReverseBFSIterator The end iterator.
+     */
+    ReverseBFSIterator end_reverse_bfs_scan() const {
+        return ReverseBFSIterator();
+    }
 
     /**
      * @brief Get an iterator to the beginning of the heap traversal.
@@ -451,7 +1067,7 @@ public:
      */
     HeapIterator begin_heap() {
         myHeap();
-        return HeapIterator(root);
+        return start<BreadthFirst>("traverse_heap");
     }
 
     /**
@@ -460,7 +1076,272 @@ public:
      * @return HeapIterator The end iterator.
      */
     HeapIterator end_heap() {
-        return HeapIterator(nullptr);
+        return HeapIterator();
     }
 
+    /**
+     * @brief Get the pre-order traversal as a lazy range, e.g. for range-for or std::views.
+     *
+     * @return TraversalRange<PreOrderIterator> The range.
+     */
+    TraversalRange<PreOrderIterator> pre_order() const {
+        return TraversalRange<PreOrderIterator>(begin_pre_order());
+    }
+
+    /**
+     * @brief Get the post-order traversal as a lazy range, e.g. for range-for or std::views.
+     *
+     * @return TraversalRange<PostOrderIterator> The range.
+     */
+    TraversalRange<PostOrderIterator> post_order() const {
+        return TraversalRange<PostOrderIterator>(begin_post_order());
+    }
+
+    /**
+     * @brief Get the in-order traversal as a lazy range, e.g. for range-for or std::views.
+     *
+     * @return TraversalRange<InOrderIterator> The range.
+     */
+    TraversalRange<InOrderIterator> in_order() const {
+        return TraversalRange<InOrderIterator>(begin_in_order(), end_in_order());
+    }
+
+    /**
+     * @brief Get an in-order traversal with a chosen split point as a lazy range.
+     *
+     * @tparam Split The split policy, e.g. SplitAt<1> to report every node after its first child.
+     * @return TraversalRange<Iterator<InOrderWith<Split>>> The range.
+     */
+    template<typename Split>
+    TraversalRange<Iterator<InOrderWith<Split>>> in_order() const {
+        using SplitIterator = Iterator<InOrderWith<Split>>;
+        return TraversalRange<SplitIterator>(SplitIterator(&root, TraversalProbe(counters, "traverse_in_order")),
+                                             SplitIterator(&root, TraversalProbe(), PastEnd()));
+    }
+
+    /**
+     * @brief Get an in-order iterator at the first node for which below(node) is false.
+     *
+     * For binary search trees, where the in-order is partitioned by the
+     * predicate: the iterator descends one path from the root, so this is a
+     * lower_bound in O(depth). The iterator is bidirectional and ends at
+     * end_in_order().
+     *
+     * @tparam Split The split policy of the in-order.
+     * @tparam Below Callable as below(const Node &node) returning bool.
+     * @param below True for the nodes before the sought position.
+     * @return Iterator<InOrderWith<Split>> The iterator, at the end if below is true for every node.
+     */
+    template<typename Split = SplitHalf, typename Below>
+    Iterator<InOrderWith<Split>> partition_point(Below below) const {
+        return Iterator<InOrderWith<Split>>(&root, TraversalProbe(counters, "traverse_in_order"), std::move(below));
+    }
+
+    /**
+     * @brief Get the breadth-first traversal as a lazy range, e.g. for range-for or std::views.
+     *
+     * @return TraversalRange<BFSIterator> The range.
+     */
+    TraversalRange<BFSIterator> bfs() const {
+        return TraversalRange<BFSIterator>(begin_bfs_scan());
+    }
+
+    /**
+     * @brief Get the depth-first traversal as a lazy range, e.g. for range-for or std::views.
+     *
+     * @return TraversalRange<DFSIterator> The range.
+     */
+    TraversalRange<DFSIterator> dfs() const {
+        return TraversalRange<DFSIterator>(begin_dfs_scan());
+    }
+
+    /**
+     * @brief Get the reverse pre-order traversal as a lazy range.
+     *
+     * @return TraversalRange<ReversePreOrderIterator> The range.
+     */
+    TraversalRange<ReversePreOrderIterator> reverse_pre_order() const {
+        return TraversalRange<ReversePreOrderIterator>(begin_reverse_pre_order());
+    }
+
+    /**
+     * @brief Get the reverse post-order traversal as a lazy range.
+     *
+     * @return TraversalRange<ReversePostOrderIterator> The range.
+     */
+    TraversalRange<ReversePostOrderIterator> reverse_post_order() const {
+        return TraversalRange<ReversePostOrderIterator>(begin_reverse_post_order());
+    }
+
+    /**
+     * @brief Get the reverse breadth-first traversal as a range.
+     *
+     * @return TraversalRange<ReverseBFSIterator> The range.
+     */
+    TraversalRange<ReverseBFSIterator> reverse_bfs() const {
+        return TraversalRange<ReverseBFSIterator>(begin_reverse_bfs_scan());
+    }
+
+    /**
+     * @brief Get a traversal that never enters pruned subtrees, as a lazy range.
+     *
+     * A node deeper than max_depth, or one for which skip(node) returns true,
+     * is left out together with its whole subtree. The check happens before
+     * the node is queued, so pruned subtrees are never walked and cost one
+     * call of skip each.
+     *
+     * @tparam Order An order tag from TreeTraversal.hpp other than ReverseBreadthFirst.
+     * @tparam Skip Callable as skip(const Node &node) returning bool.
+     * @param max_depth The deepest level visited, 0 for the root only; NO_DEPTH_LIMIT for none.
+     * @param skip Decides which subtrees to leave out.
+     * @return TraversalRange<Iterator<Pruned<Order, Skip>>> The range.
+     */
+    template<typename Order, typename Skip = SkipNone>
+    TraversalRange<Iterator<Pruned<Order, Skip>>> pruned(std::size_t max_depth, Skip skip = Skip()) const {
+        using PrunedIterator = Iterator<Pruned<Order, Skip>>;
+        return TraversalRange<PrunedIterator>(
+                PrunedIterator(&root, TraversalProbe(counters, OrderTraits<Pruned<Order, Skip>, D>::NAME),
+                               Pruning<Skip>(max_depth, std::move(skip))));
+    }
+
+    /**
+     * @brief Get a depth-first traversal limited in depth and skipping subtrees, as a lazy range.
+     *
+     * @param max_depth The deepest level visited, 0 for the root only; NO_DEPTH_LIMIT for none.
+     * @param skip Callable as skip(const Node &node); true leaves out the node and its subtree.
+     * @return TraversalRange<PrunedDFSIterator<Skip>> The range.
+     */
+    template<typename Skip = SkipNone>
+    TraversalRange<PrunedDFSIterator<Skip>> dfs(std::size_t max_depth, Skip skip = Skip()) const {
+        return pruned<DepthFirst>(max_depth, std::move(skip));
+    }
+
+    /**
+     * @brief Get a breadth-first traversal limited in depth and skipping subtrees, as a lazy range.
+     *
+     * @param max_depth The deepest level visited, 0 for the root only; NO_DEPTH_LIMIT for none.
+     * @param skip Callable as skip(const Node &node); true leaves out the node and its subtree.
+     * @return TraversalRange<PrunedBFSIterator<Skip>> The range.
+     */
+    template<typename Skip = SkipNone>
+    TraversalRange<PrunedBFSIterator<Skip>> bfs(std::size_t max_depth, Skip skip = Skip()) const {
+        return pruned<BreadthFirst>(max_depth, std::move(skip));
+    }
+
+    /**
+     * @brief Get an iterator to the first level of the level-by-level traversal.
+     *
+     * @return LevelIterator The iterator at the root's level.
+     */
+    LevelIterator begin_levels() const {
+        return LevelIterator(&root, TraversalProbe(counters, "traverse_levels"));
+    }
+
+    /**
+     * @brief Get the end iterator of the level-by-level traversal.
+     *
+     * @return LevelIterator The end iterator.
+     */
+    LevelIterator end_levels() const {
+        return LevelIterator();
+    }
+
+    /**
+     * @brief Get the breadth-first traversal as a lazy range of whole levels.
+     *
+     * @return TraversalRange<LevelIterator> The range.
+     */
+    TraversalRange<LevelIterator> levels() const {
+        return TraversalRange<LevelIterator>(begin_levels());
+    }
+
+    /**
+     * @brief Convert the tree into a min-heap and get its breadth-first traversal as a range.
+     *
+     * @return TraversalRange<HeapIterator> The range.
+     */
+    TraversalRange<HeapIterator> heap() {
+        return TraversalRange<HeapIterator>(begin_heap());
+    }
+
+#ifdef TREE_HAS_COROUTINES
+    /**
+     * @brief Get a traversal as a coroutine generator, for code that reads best as a recursive walk.
+     *
+     * The depth-first orders are written as plain recursion over the children;
+     * nested generators are resumed directly, so each node costs O(1) and the
+     * suspended frames, one per level, use O(depth) memory on the heap. The
+     * generator is single-pass and the tree must outlive it.
+     *
+     * @tparam Order An order tag from TreeTraversal.hpp, e.g. PreOrder or ReverseBreadthFirst.
+     * @return Generator<std::shared_ptr<Node>> The nodes in that order, empty for an empty tree.
+     */
+    template<typename Order>
+    Generator<std::shared_ptr<Node>> generate() const {
+        if (!root)
+            return Generator<std::shared_ptr<Node>>();
+        counters.traversal_started();
+        if constexpr (std::is_same<Order, BreadthFirst>::value) {
+            return breadth_first(root);
+        } else if constexpr (std::is_same<Order, ReverseBreadthFirst>::value) {
+            return reverse_breadth_first(root);
+        } else {
+            return depth_first<typename OrderTraits<Order, D>::Split>(root);
+        }
+    }
+
+private:
+    /**
+     * @brief Yield a subtree, reporting each node after split_of<Split>(node) of its children.
+     */
+    template<typename Split>
+    static Generator<std::shared_ptr<Node>> depth_first(const std::shared_ptr<Node> &node) {
+        const auto &children = node->children;
+        const std::size_t split = split_of<Split>(*node);
+        for (std::size_t i = 0; i < split; ++i) {
+            co_yield elements_of(depth_first<Split>(children[split_child<Split>(i, children.size())]));
+        }
+        co_yield node;
+        for (std::size_t i = split; i < children.size(); ++i) {
+            co_yield elements_of(depth_first<Split>(children[split_child<Split>(i, children.size())]));
+        }
+    }
+
+    /**
+     * @brief Yield a tree level by level.
+     */
+    static Generator<std::shared_ptr<Node>> breadth_first(const std::shared_ptr<Node> &start) {
+        std::deque<const std::shared_ptr<Node> *> queue{&start};
+        while (!queue.empty()) {
+            const std::shared_ptr<Node> *node = queue.front();
+            queue.pop_front();
+            for (const auto &child : (*node)->children) {
+                queue.push_back(&child);
+            }
+            co_yield *node;
+        }
+    }
+
+    /**
+     * @brief Yield a tree level by level from the last node back to the root.
+     */
+    static Generator<std::shared_ptr<Node>> reverse_breadth_first(const std::shared_ptr<Node> &start) {
+        ReverseBreadthFirstCursor<Node> cursor(&start);
+        while (const std::shared_ptr<Node> *node = cursor.current()) {
+            co_yield *node;
+            cursor.advance();
+        }
+    }
+
+public:
+#endif // TREE_HAS_COROUTINES
+
 };
+
+template<typename T, unsigned int D>
+constexpr std::size_t Tree<T, D>::NO_PARENT;
+
+template<typename T, unsigned int D>
+constexpr std::size_t Tree<T, D>::NO_DEPTH_LIMIT;
+
+#endif // TREESITERATORS_CPP_TREE_HPP
@@ -0,0 +1,646 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_TREEBINARY_HPP
+#define TREESITERATORS_CPP_TREEBINARY_HPP
+
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include <fcntl.h>     // For open
+#include <sys/mman.h>  // For mmap, munmap
+#include <sys/stat.h>  // For fstat
+#include <unistd.h>    // For close
+#include "Tree.hpp"
+#include "TreeWriter.hpp"
+
+/**
+ * @brief Header at the start of every binary tree file.
+ *
+ * The file stores the nodes in pre-order: first the keys of all nodes as a
+ * contiguous array of T, then the child count of every node as uint32_t.
+ * Both arrays start at offsets aligned for their element type so that a
+ * memory-mapped file can be read in place.
+ */
+struct TreeBinaryHeader {
+    char magic[8];                 ///< Always "TREEBIN\0".
+    std::uint32_t version;         ///< Format version, currently 1.
+    std::uint32_t byte_order;      ///< BYTE_ORDER_MARK as written by the producing machine.
+    std::uint32_t degree;          ///< The D of the saved Tree<T, D>.
+    std::uint32_t key_size;        ///< sizeof(T) of the saved keys.
+    std::uint64_t node_count;      ///< Number of nodes in the tree.
+    std::uint64_t keys_offset;     ///< File offset of the key array.
+    std::uint64_t counts_offset;   ///< File offset of the child count array.
+
+    static const std::uint32_t VERSION = 1;                  ///< Current format version.
+    static const std::uint32_t BYTE_ORDER_MARK = 0x01020304; ///< Detects files from a different endianness.
+};
+
+/**
+ * @brief Round an offset up to a multiple of an alignment.
+ *
+ * @param offset The offset to round.
+ * @param alignment The alignment, a power of two.
+ * @return std::uint64_t The aligned offset.
+ */
+inline std::uint64_t align_offset(std::uint64_t offset, std::uint64_t alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+/**
+ * @brief Write a tree in the binary format to a stream, in pre-order with child counts.
+ *
+ * Keys are written inline, so T must be trivially copyable. The tree is
+ * walked three times (count, keys, child counts) with an explicit stack and
+ * the output goes through a fixed-size buffer, so memory use does not depend
+ * on the number of nodes and the stream never has to seek.
+ *
+ * @tparam T The type of the keys, must be trivially copyable.
+ * @tparam D The degree of the tree.
+ * @param tree The tree to write.
+ * @param out The stream to write to, opened in binary mode.
+ * @throws std::runtime_error If writing fails.
+ */
+template<typename T, unsigned int D>
+void write_binary(const Tree<T, D> &tree, std::ostream &out) {
+    static_assert(std::is_trivially_copyable<T>::value, "Binary tree files store keys inline; T must be trivially copyable.");
+    using Node = typename Tree<T, D>::Node;
+    auto nothing = [](const Node &) {};
+
+    TreeBinaryHeader header{};
+    std::memcpy(header.magic, "TREEBIN", 8);
+    header.version = TreeBinaryHeader::VERSION;
+    header.byte_order = TreeBinaryHeader::BYTE_ORDER_MARK;
+    header.degree = D;
+    header.key_size = sizeof(T);
+    walk_pre_order(tree.get_root(), [&header](const Node &, std::size_t) { ++header.node_count; }, nothing);
+    header.keys_offset = align_offset(sizeof(TreeBinaryHeader), alignof(T));
+    std::uint64_t keys_end = header.keys_offset + header.node_count * sizeof(T);
+    header.counts_offset = align_offset(keys_end, alignof(std::uint32_t));
+
+    BufferedWriter writer(out);
+    const char padding[64] = {};
+    writer.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writer.write(padding, static_cast<std::size_t>(header.keys_offset - sizeof(header)));
+    walk_pre_order(tree.get_root(), [&writer](const Node &node, std::size_t) {
+        writer.write(reinterpret_cast<const char *>(&node.key), sizeof(T));
+    }, nothing);
+    writer.write(padding, static_cast<std::size_t>(header.counts_offset - keys_end));
+    walk_pre_order(tree.get_root(), [&writer](const Node &node, std::size_t) {
+        auto count = static_cast<std::uint32_t>(node.children.size());
+        writer.write(reinterpret_cast<const char *>(&count), sizeof(count));
+    }, nothing);
+    writer.flush();
+}
+
+/**
+ * @brief Save a tree to a binary file, see write_binary.
+ *
+ * @tparam T The type of the keys, must be trivially copyable.
+ * @tparam D The degree of the tree.
+ * @param tree The tree to save.
+ * @param path The file to create or overwrite.
+ * @throws std::runtime_error If the file cannot be written.
+ */
+template<typename T, unsigned int D>
+void save_binary(const Tree<T, D> &tree, const std::string &path) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("Cannot open " + path + " for writing.");
+    }
+    write_binary(tree, out);
+}
+
+/**
+ * @brief A read-only view of a binary tree file mapped into memory.
+ *
+ * Keys and child counts are used in place, so opening a file costs one mmap
+ * call regardless of the tree size and no node is allocated. The view offers
+ * the same begin_ / end_ traversal pairs as Tree, except heap (which would
+ * have to modify the tree). Dereferencing an iterator yields a NodeRef, so
+ * loops written as (*it)->key work unchanged.
+ *
+ * Pre-order, DFS, post-order and in-order walk the file front to back with a
+ * stack bounded by the tree depth. BFS needs random access to children and
+ * computes the subtree sizes once, on its first use.
+ *
+ * @tparam T The type of the keys, must be trivially copyable.
+ * @tparam D The degree of the saved tree.
+ */
+template<typename T, unsigned int D = 2>
+class TreeView {
+    static_assert(std::is_trivially_copyable<T>::value, "Binary tree files store keys inline; T must be trivially copyable.");
+
+public:
+    /**
+     * @brief A lightweight handle to one node of the view.
+     */
+    class NodeRef {
+    public:
+        const T &key;  ///< The key of the node, pointing into the mapped file.
+
+        /**
+         * @brief Construct a handle to a node.
+         *
+         * @param view The view the node belongs to.
+         * @param index The pre-order index of the node.
+         */
+        NodeRef(const TreeView *view, std::size_t index) : key(view->keys[index]), view(view), position(index) {}
+
+        /**
+         * @brief Get the pre-order index of the node.
+         *
+         * @return std::size_t The index of the node in the file.
+         */
+        std::size_t index() const {
+            return position;
+        }
+
+        /**
+         * @brief Get the number of children of the node.
+         *
+         * @return std::size_t The child count.
+         */
+        std::size_t child_count() const {
+            return view->counts[position];
+        }
+
+        /**
+         * @brief Member access, so that (*it)->key works as it does for Tree iterators.
+         *
+         * @return const NodeRef* This handle.
+         */
+        const NodeRef *operator->() const {
+            return this;
+        }
+
+    private:
+        const TreeView *view;   ///< The view the node belongs to.
+        std::size_t position;   ///< The pre-order index of the node.
+    };
+
+    /**
+     * @brief Map a binary tree file written by save_binary.
+     *
+     * The header and the child counts are validated here, so the iterators
+     * never read outside the mapping.
+     *
+     * @param path The file to open.
+     * @throws std::runtime_error If the file cannot be mapped, does not match Tree<T, D> or is corrupt.
+     */
+    explicit TreeView(const std::string &path) : mapping(new Mapping(path)) {
+        const auto *bytes = static_cast<const unsigned char *>(mapping->data);
+        if (mapping->size < sizeof(TreeBinaryHeader)) {
+            throw std::runtime_error(path + " is not a binary tree file.");
+        }
+        TreeBinaryHeader header;
+        std::memcpy(&header, bytes, sizeof(header));
+        if (std::memcmp(header.magic, "TREEBIN", 8) != 0 || header.version != TreeBinaryHeader::VERSION) {
+            throw std::runtime_error(path + " is not a binary tree file.");
+        }
+        if (header.byte_order != TreeBinaryHeader::BYTE_ORDER_MARK || header.degree != D || header.key_size != sizeof(T)) {
+            throw std::runtime_error(path + " was written for a different tree type or machine.");
+        }
+        // Divide rather than multiply, so that a huge node_count cannot wrap around
+        if (header.keys_offset % alignof(T) != 0 || header.counts_offset % alignof(std::uint32_t) != 0 ||
+            header.keys_offset > mapping->size || header.counts_offset > mapping->size ||
+            header.node_count > (mapping->size - header.keys_offset) / sizeof(T) ||
+            header.node_count > (mapping->size - header.counts_offset) / sizeof(std::uint32_t)) {
+            throw std::runtime_error(path + " is truncated or corrupt.");
+        }
+        node_count = static_cast<std::size_t>(header.node_count);
+        keys = reinterpret_cast<const T *>(bytes + header.keys_offset);
+        counts = reinterpret_cast<const std::uint32_t *>(bytes + header.counts_offset);
+        if (!valid_counts()) {
+            throw std::runtime_error(path + " is truncated or corrupt.");
+        }
+    }
+
+    /**
+     * @brief Get the number of nodes in the view.
+     *
+     * @return std::size_t The node count.
+     */
+    std::size_t size() const {
+        return node_count;
+    }
+
+    /**
+     * @brief Get the number of children of a node.
+     *
+     * @param index The pre-order index of the node.
+     * @return std::size_t The child count.
+     */
+    std::size_t child_count(std::size_t index) const {
+        return counts[index];
+    }
+
+    /**
+     * @brief Get the keys of all nodes in pre-order.
+     *
+     * @return const T* Pointer to the contiguous key array inside the mapping.
+     */
+    const T *data() const {
+        return keys;
+    }
+
+    /**
+     * @brief Iterator for pre-order traversal, a plain scan of the file.
+     */
+    class PreOrderIterator {
+    public:
+        /**
+         * @brief Construct an iterator at a pre-order index.
+         *
+         * @param view The view to traverse.
+         * @param index The index of the current node; size() marks the end.
+         */
+        PreOrderIterator(const TreeView *view, std::size_t index) : view(view), index(index) {}
+
+        /**
+         * @brief Advance the iterator to the next element.
+         *
+         * @return PreOrderIterator& Reference to the current iterator.
+         */
+        PreOrderIterator &operator++() {
+            ++index;
+            return *this;
+        }
+
+        /**
+         * @brief Check if two iterators are not equal.
+         *
+         * @param other Another iterator to compare with.
+         * @return true If the iterators point at different nodes.
+         */
+        bool operator!=(const PreOrderIterator &other) const {
+            return index != other.index;
+        }
+
+        /**
+         * @brief Dereference the iterator to get the current node.
+         *
+         * @return NodeRef The current node.
+         */
+        NodeRef operator*() const {
+            return NodeRef(view, index);
+        }
+
+    private:
+        const TreeView *view;  ///< The view being traversed.
+        std::size_t index;     ///< The pre-order index of the current node.
+    };
+
+    /**
+     * @brief Iterator for traversals that finish a subtree before reporting some of its nodes.
+     *
+     * Scans the file front to back keeping the path from the root as a stack
+     * of (node, children still to scan). A node is reported once
+     * Split::at(children) of its children have been finished, with the split
+     * policies of TreeTraversal.hpp: SplitBefore gives pre-order, SplitHalf the
+     * in-order of Tree and SplitAfter post-order.
+     *
+     * @tparam Split The split policy.
+     */
+    template<typename Split>
+    class ScanIterator {
+    public:
+        /**
+         * @brief Construct an iterator at the beginning or the end of the traversal.
+         *
+         * @param view The view to traverse.
+         * @param at_end Whether to construct the end iterator.
+         */
+        ScanIterator(const TreeView *view, bool at_end) : view(view), position(at_end ? view->size() : 0), current(view->size()) {
+            if (!at_end)
+                advance();
+        }
+
+        /**
+         * @brief Advance the iterator to the next element.
+         *
+         * @return ScanIterator& Reference to the current iterator.
+         */
+        ScanIterator &operator++() {
+            advance();
+            return *this;
+        }
+
+        /**
+         * @brief Check if two iterators are not equal.
+         *
+         * @param other Another iterator to compare with.
+         * @return true If the iterators point at different nodes.
+         */
+        bool operator!=(const ScanIterator &other) const {
+            return current != other.current;
+        }
+
+        /**
+         * @brief Dereference the iterator to get the current node.
+         *
+         * @return NodeRef The current node.
+         */
+        NodeRef operator*() const {
+            return NodeRef(view, current);
+        }
+
+    private:
+        /**
+         * @brief A node on the path from the root to the scan position.
+         */
+        struct Frame {
+            std::size_t index;      ///< The pre-order index of the node.
+            std::size_t remaining;  ///< Children not scanned yet.
+            bool reported;          ///< Whether the node has been yielded.
+        };
+
+        const TreeView *view;       ///< The view being traversed.
+        std::size_t position;       ///< The next index to scan.
+        std::size_t current;        ///< The index of the current node, size() at the end.
+        std::vector<Frame> path;    ///< The open ancestors of the scan position.
+
+        /**
+         * @brief Move to the next node to report.
+         */
+        void advance() {
+            while (true) {
+                if (!path.empty()) {
+                    Frame &top = path.back();
+                    std::size_t count = view->counts[top.index];
+                    std::size_t finished = count - top.remaining;
+                    if (!top.reported && finished >= Split::at(count)) {
+                        top.reported = true;
+                        current = top.index;
+                        return;
+                    }
+                    if (top.remaining == 0) {
+                        path.pop_back();
+                        continue;
+                    }
+                    --top.remaining;
+                } else if (position != 0 || position >= view->size()) {
+                    current = view->size();
+                    return;
+                }
+                path.push_back(Frame{position, view->counts[position], false});
+                ++position;
+            }
+        }
+    };
+
+    using PostOrderIterator = ScanIterator<SplitAfter>;  ///< Children first, then the node.
+    using InOrderIterator = ScanIterator<SplitHalf>;     ///< The first ceil(k/2) children, the node, then the rest, as in Tree.
+    using DFSIterator = PreOrderIterator;                                    ///< Depth-first order equals pre-order.
+
+    /**
+     * @brief Iterator for breadth-first traversal.
+     */
+    class BFSIterator {
+    public:
+        /**
+         * @brief Construct an iterator at the beginning or the end of the traversal.
+         *
+         * @param view The view to traverse.
+         * @param at_end Whether to construct the end iterator.
+         */
+        BFSIterator(const TreeView *view, bool at_end) : view(view), sizes(nullptr) {
+            if (!at_end && view->size() > 0) {
+                sizes = &view->subtree_sizes();
+                queue.push_back(0);
+            }
+        }
+
+        /**
+         * @brief Advance the iterator to the next element.
+         *
+         * @return BFSIterator& Reference to the current iterator.
+         */
+        BFSIterator &operator++() {
+            std::size_t node = queue.front();
+            queue.pop_front();
+            std::size_t child = node + 1;
+            for (std::uint32_t i = 0; i < view->counts[node]; ++i) {
+                queue.push_back(child);
+                child += (*sizes)[child];
+            }
+            return *this;
+        }
+
+        /**
+         * @brief Check if two iterators are not equal.
+         *
+         * @param other Another iterator to compare with.
+         * @return true If the iterators point at different nodes.
+         */
+        bool operator!=(const BFSIterator &other) const {
+            if (queue.empty() || other.queue.empty())
+                return queue.empty() != other.queue.empty();
+            return queue.front() != other.queue.front();
+        }
+
+        /**
+         * @brief Dereference the iterator to get the current node.
+         *
+         * @return NodeRef The current node.
+         */
+        NodeRef operator*() const {
+            return NodeRef(view, queue.front());
+        }
+
+    private:
+        const TreeView *view;                    ///< The view being traversed.
+        const std::vector<std::size_t> *sizes;   ///< Subtree size of every node.
+        std::deque<std::size_t> queue;           ///< Discovered nodes, the front is current.
+    };
+
+    /**
+     * @brief Get the root node.
+     *
+     * @return NodeRef The root node; the view must not be empty.
+     * @throws std::logic_error If the view is empty.
+     */
+    NodeRef get_root() const {
+        if (node_count == 0) {
+            throw std::logic_error("Tree is empty.");
+        }
+        return NodeRef(this, 0);
+    }
+
+    /** @brief Beginning of the pre-order traversal. */
+    PreOrderIterator begin_pre_order() const { return PreOrderIterator(this, 0); }
+    /** @brief End of the pre-order traversal. */
+    PreOrderIterator end_pre_order() const { return PreOrderIterator(this, node_count); }
+    /** @brief Beginning of the post-order traversal. */
+    PostOrderIterator begin_post_order() const { return PostOrderIterator(this, false); }
+    /** @brief End of the post-order traversal. */
+    PostOrderIterator end_post_order() const { return PostOrderIterator(this, true); }
+    /** @brief Beginning of the in-order traversal. */
+    InOrderIterator begin_in_order() const { return InOrderIterator(this, false); }
+    /** @brief End of the in-order traversal. */
+    InOrderIterator end_in_order() const { return InOrderIterator(this, true); }
+    /** @brief Beginning of the breadth-first traversal. */
+    BFSIterator begin_bfs_scan() const { return BFSIterator(this, false); }
+    /** @brief End of the breadth-first traversal. */
+    BFSIterator end_bfs_scan() const { return BFSIterator(this, true); }
+    /** @brief Beginning of the depth-first traversal. */
+    DFSIterator begin_dfs_scan() const { return begin_pre_order(); }
+    /** @brief End of the depth-first traversal. */
+    DFSIterator end_dfs_scan() const { return end_pre_order(); }
+
+private:
+    /**
+     * @brief Owner of a read-only memory mapping of a whole file.
+     */
+    struct Mapping {
+        const void *data = nullptr;  ///< Start of the mapping.
+        std::size_t size = 0;        ///< Length of the mapping in bytes.
+
+        /**
+         * @brief Map a file read-only.
+         *
+         * @param path The file to map.
+         * @throws std::runtime_error If the file cannot be opened or mapped.
+         */
+        explicit Mapping(const std::string &path) {
+            int fd = ::open(path.c_str(), O_RDONLY);
+            if (fd < 0) {
+                throw std::runtime_error("Cannot open " + path + ".");
+            }
+            struct stat info{};
+            if (::fstat(fd, &info) != 0 || info.st_size <= 0) {
+                ::close(fd);
+                throw std::runtime_error("Cannot map " + path + ".");
+            }
+            size = static_cast<std::size_t>(info.st_size);
+            void *address = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            ::close(fd);  // the mapping stays valid after the descriptor is closed
+            if (address == MAP_FAILED) {
+                throw std::runtime_error("Cannot map " + path + ".");
+            }
+            data = address;
+        }
+
+        Mapping(const Mapping &) = delete;
+        Mapping &operator=(const Mapping &) = delete;
+
+        ~Mapping() {
+            ::munmap(const_cast<void *>(data), size);
+        }
+    };
+
+    /**
+     * @brief Subtree sizes, computed by the first BFS.
+     */
+    struct SizeCache {
+        std::once_flag once;             ///< Guards the one-time computation.
+        std::vector<std::size_t> sizes;  ///< Subtree size of every node in pre-order.
+    };
+
+    std::shared_ptr<Mapping> mapping;                                        ///< The mapped file, shared by copies of the view.
+    std::shared_ptr<SizeCache> cache = std::make_shared<SizeCache>();        ///< Lazily computed subtree sizes.
+    std::size_t node_count = 0;                                              ///< Number of nodes.
+    const T *keys = nullptr;                                                 ///< Keys in pre-order, inside the mapping.
+    const std::uint32_t *counts = nullptr;                                   ///< Child counts in pre-order, inside the mapping.
+
+    /**
+     * @brief Check that the child counts describe exactly one tree of node_count nodes.
+     *
+     * One scan keeps the number of nodes still owed to the open subtrees: it
+     * starts at one for the root, and every node pays one and owes its own
+     * children. It must never run out before the last node nor remain after it.
+     * A node may have more than D children, since Tree does not enforce its
+     * degree and write_binary saves such trees as they are.
+     *
+     * @return true If every node is reachable from the root and every claimed child exists.
+     */
+    bool valid_counts() const {
+        std::size_t pending = node_count == 0 ? 0 : 1;
+        for (std::size_t i = 0; i < node_count; ++i) {
+            if (pending == 0) {
+                return false;
+            }
+            pending = pending - 1 + counts[i];
+            if (pending > node_count - i - 1) {
+                return false;
+            }
+        }
+        return pending == 0;
+    }
+
+    /**
+     * @brief Get the size of every subtree, computing them on first use.
+     *
+     * A backwards scan is enough: the children of node i start at i + 1 and
+     * each one is followed by its own subtree.
+     *
+     * @return const std::vector<std::size_t>& The subtree size of every node.
+     */
+    const std::vector<std::size_t> &subtree_sizes() const {
+        std::call_once(cache->once, [this]() {
+            std::vector<std::size_t> &sizes = cache->sizes;
+            sizes.assign(node_count, 1);
+            for (std::size_t i = node_count; i-- > 0;) {
+                std::size_t child = i + 1;
+                for (std::uint32_t c = 0; c < counts[i]; ++c) {
+                    sizes[i] += sizes[child];
+                    child += sizes[child];
+                }
+            }
+        });
+        return cache->sizes;
+    }
+};
+
+/**
+ * @brief Load a binary tree file into a regular, modifiable Tree.
+ *
+ * The parent of every node is recovered from the child counts with a stack in
+ * one scan, then the tree is built with build_from_parent_array.
+ *
+ * @tparam T The type of the keys, must be trivially copyable.
+ * @tparam D The degree of the tree.
+ * @param path The file to load.
+ * @return Tree<T, D> The loaded tree.
+ * @throws std::runtime_error If the file cannot be read or does not match Tree<T, D>.
+ */
+template<typename T, unsigned int D = 2>
+Tree<T, D> load_binary(const std::string &path) {
+    TreeView<T, D> view(path);
+    std::vector<std::size_t> parents(view.size());
+    std::vector<std::pair<std::size_t, std::size_t>> open;  // (node, children still unassigned)
+    for (std::size_t i = 0; i < view.size(); ++i) {
+        while (!open.empty() && open.back().second == 0) {
+            open.pop_back();
+        }
+        if (open.empty()) {
+            if (i != 0) {
+                throw std::runtime_error(path + " is truncated or corrupt.");
+            }
+            parents[i] = Tree<T, D>::NO_PARENT;
+        } else {
+            parents[i] = open.back().first;
+            --open.back().second;
+        }
+        open.emplace_back(i, view.child_count(i));
+    }
+    while (!open.empty() && open.back().second == 0) {
+        open.pop_back();
+    }
+    if (!open.empty()) {
+        throw std::runtime_error(path + " is truncated or corrupt.");  // more children claimed than stored
+    }
+
+    Tree<T, D> tree;
+    tree.build_from_parent_array(parents, std::vector<T>(view.data(), view.data() + view.size()));
+    return tree;
+}
+
+#endif // TREESITERATORS_CPP_TREEBINARY_HPP
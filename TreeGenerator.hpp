@@ -0,0 +1,266 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_TREEGENERATOR_HPP
+#define TREESITERATORS_CPP_TREEGENERATOR_HPP
+
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define TREE_HAS_COROUTINES 1
+
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <iterator>
+#include <utility>
+#include <vector>
+#if __has_include(<ranges>)
+#include <ranges>
+#endif
+
+template<typename T>
+class Generator;
+
+/**
+ * @brief Wraps a generator so that `co_yield elements_of(g)` yields all of g's elements in place.
+ *
+ * @tparam T The element type of the generator.
+ */
+template<typename T>
+struct ElementsOf {
+    Generator<T> generator;  ///< The nested generator, run to completion by the outer one.
+};
+
+/**
+ * @brief Yield every element of a nested generator from the enclosing generator.
+ *
+ * @param generator The nested generator.
+ * @return ElementsOf<T> The wrapper to co_yield.
+ */
+template<typename T>
+ElementsOf<T> elements_of(Generator<T> generator) {
+    return ElementsOf<T>{std::move(generator)};
+}
+
+/**
+ * @brief A lazy, recursive coroutine generator of references to T, a stand-in for C++23 std::generator.
+ *
+ * Nested generators yielded with elements_of() are pushed on a stack owned
+ * by the outermost generator, which always resumes the innermost one
+ * directly. Every element therefore costs O(1) regardless of the nesting
+ * depth, and deep recursion lives in heap-allocated coroutine frames instead
+ * of on the call stack.
+ *
+ * @tparam T The element type; elements are yielded as const T&.
+ */
+template<typename T>
+class Generator {
+public:
+    struct promise_type;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    /**
+     * @brief Coroutine state; only the outermost promise uses stack and value.
+     */
+    struct promise_type {
+        promise_type *root = this;                 ///< The outermost generator's promise.
+        std::vector<Handle> stack;                 ///< Active coroutines, innermost last (root only).
+        const T *value = nullptr;                  ///< The element just yielded (root only).
+        std::exception_ptr exception;              ///< An exception escaping this coroutine.
+
+        Generator get_return_object() {
+            return Generator(Handle::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        /**
+         * @brief Publish an element and suspend until the consumer advances.
+         */
+        std::suspend_always yield_value(const T &element) noexcept {
+            root->value = &element;
+            return {};
+        }
+
+        /**
+         * @brief Suspends the current coroutine and makes a nested generator the innermost one.
+         */
+        struct NestedAwaiter {
+            Generator nested;  ///< The nested generator until it is handed to the root's stack.
+
+            bool await_ready() const noexcept {
+                return !nested.handle;
+            }
+
+            void await_suspend(Handle current) noexcept {
+                // The root's stack owns the nested frame from now on and destroys it
+                // when it finishes, so teardown never recurses through the frames.
+                Handle handle = std::exchange(nested.handle, nullptr);
+                promise_type &nested_promise = handle.promise();
+                nested_promise.root = current.promise().root;
+                nested_promise.root->stack.push_back(handle);
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        /**
+         * @brief Yield all elements of a nested generator.
+         */
+        NestedAwaiter yield_value(ElementsOf<T> elements) noexcept {
+            return NestedAwaiter{std::move(elements.generator)};
+        }
+
+        void return_void() noexcept {}
+
+        void unhandled_exception() {
+            exception = std::current_exception();
+        }
+    };
+
+    /**
+     * @brief Single-pass iterator over the elements; compares equal to std::default_sentinel at the end.
+     */
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using reference = const T &;
+
+        Iterator() = default;
+
+        explicit Iterator(promise_type *root) : root(root) {}
+
+        reference operator*() const {
+            return *root->value;
+        }
+
+        const T *operator->() const {
+            return root->value;
+        }
+
+        Iterator &operator++() {
+            advance(root);
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        friend bool operator==(const Iterator &it, std::default_sentinel_t) {
+            return !it.root || it.root->stack.empty();
+        }
+
+    private:
+        promise_type *root = nullptr;  ///< The outermost generator's promise.
+    };
+
+    Generator() = default;
+
+    Generator(Generator &&other) noexcept : handle(std::exchange(other.handle, nullptr)) {}
+
+    Generator &operator=(Generator &&other) noexcept {
+        if (this != &other) {
+            destroy();
+            handle = std::exchange(other.handle, nullptr);
+        }
+        return *this;
+    }
+
+    Generator(const Generator &) = delete;
+    Generator &operator=(const Generator &) = delete;
+
+    ~Generator() {
+        destroy();
+    }
+
+    /**
+     * @brief Start the coroutine and run it to its first element; call once.
+     *
+     * @throws Any exception thrown by the coroutine before its first element.
+     */
+    Iterator begin() {
+        if (!handle)
+            return Iterator();
+        promise_type &root = handle.promise();
+        root.stack.push_back(handle);
+        advance(&root);
+        return Iterator(&root);
+    }
+
+    /**
+     * @brief Get the end sentinel.
+     */
+    std::default_sentinel_t end() const noexcept {
+        return std::default_sentinel;
+    }
+
+private:
+    Handle handle;  ///< The coroutine this generator owns.
+
+    explicit Generator(Handle handle) : handle(handle) {}
+
+    /**
+     * @brief Resume the innermost coroutine until one yields an element or all have finished.
+     *
+     * @param root The outermost promise.
+     * @throws Any exception thrown by one of the coroutines.
+     */
+    static void advance(promise_type *root) {
+        root->value = nullptr;
+        while (!root->stack.empty()) {
+            Handle top = root->stack.back();
+            top.resume();
+            if (!top.done()) {
+                if (root->value)
+                    return;
+                continue;  // a nested generator was pushed
+            }
+            root->stack.pop_back();
+            std::exception_ptr exception = top.promise().exception;
+            if (!root->stack.empty())
+                top.destroy();  // a finished nested generator; the root frame belongs to its Generator
+            if (exception) {
+                unwind(root);  // the iterator now reads as finished
+                std::rethrow_exception(exception);
+            }
+        }
+    }
+
+    /**
+     * @brief Destroy the suspended nested coroutines, innermost first, and empty the stack.
+     */
+    static void unwind(promise_type *root) {
+        while (root->stack.size() > 1) {
+            root->stack.back().destroy();
+            root->stack.pop_back();
+        }
+        root->stack.clear();
+    }
+
+    void destroy() {
+        if (handle) {
+            unwind(&handle.promise());
+            handle.destroy();
+        }
+        handle = nullptr;
+    }
+};
+
+#if defined(__cpp_lib_ranges)
+/**
+ * @brief Generators are single-pass views, like std::generator.
+ */
+template<typename T>
+inline constexpr bool std::ranges::enable_view<Generator<T>> = true;
+#endif
+
+#endif // __cpp_impl_coroutine
+
+#endif // TREESITERATORS_CPP_TREEGENERATOR_HPP
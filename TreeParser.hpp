@@ -0,0 +1,642 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_TREEPARSER_HPP
+#define TREESITERATORS_CPP_TREEPARSER_HPP
+
+#include <algorithm>
+#include <charconv>  // For std::from_chars
+#include <cstdio>    // For EOF
+#include <istream>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+#include "Complex.hpp"
+#include "Tree.hpp"
+
+/**
+ * @brief Parse a key from its text form, the reverse of GUI.hpp's toString.
+ *
+ * The primary template handles arithmetic types with std::from_chars; bool,
+ * Complex, CachedComplex and std::string are specialized below.
+ *
+ * @tparam B The key type.
+ * @param text The text to parse, without surrounding whitespace.
+ * @return B The parsed key.
+ * @throws std::invalid_argument If the whole text is not a valid B.
+ */
+template<typename B>
+inline B fromString(std::string_view text) {
+    static_assert(std::is_arithmetic<B>::value, "fromString needs a specialization for non-arithmetic keys.");
+    const char *first = text.data();
+    const char *last = text.data() + text.size();
+    if (last - first > 1 && *first == '+')
+        ++first;
+    B value{};
+    auto result = std::from_chars(first, last, value);
+    if (result.ec != std::errc() || result.ptr != last) {
+        throw std::invalid_argument("Cannot parse key \"" + std::string(text) + "\".");
+    }
+    return value;
+}
+
+/**
+ * @brief Parse a bool key written as "true" or "false", as the tree writers do.
+ */
+template<>
+inline bool fromString(std::string_view text) {
+    if (text == "true")
+        return true;
+    if (text == "false")
+        return false;
+    throw std::invalid_argument("Cannot parse key \"" + std::string(text) + "\".");
+}
+
+template<>
+inline std::string fromString(std::string_view text) {
+    return std::string(text);
+}
+
+/**
+ * @brief Parse a complex number written as "a + bi", "a - bi", "a", or "bi".
+ *
+ * Accepts Complex::toString output, including "a + -bi" for negative imaginary
+ * parts and non-finite parts such as "inf + 1i", "1 - infi" or "nan + 0i".
+ */
+template<>
+inline Complex fromString(std::string_view text) {
+    auto fail = [&text]() {
+        return std::invalid_argument("Cannot parse complex key \"" + std::string(text) + "\".");
+    };
+    auto skip_spaces = [&text](std::size_t at) {
+        while (at < text.size() && (text[at] == ' ' || text[at] == '\t'))
+            ++at;
+        return at;
+    };
+    auto number_end = [&text](std::size_t at) {
+        if (at < text.size() && (text[at] == '+' || text[at] == '-'))
+            ++at;
+        // An infinite part has an 'i' of its own, which is not the imaginary suffix
+        auto spelled = [&text, at](std::string_view word) {
+            if (text.size() - at < word.size())
+                return false;
+            for (std::size_t k = 0; k < word.size(); ++k) {
+                if ((text[at + k] | 0x20) != word[k])
+                    return false;
+            }
+            return true;
+        };
+        if (spelled("infinity"))
+            return at + 8;
+        if (spelled("inf"))
+            return at + 3;
+        while (at < text.size() && text[at] != ' ' && text[at] != '\t' && text[at] != 'i' &&
+               !((text[at] == '+' || text[at] == '-') && text[at - 1] != 'e' && text[at - 1] != 'E'))
+            ++at;
+        return at;
+    };
+
+    std::size_t end = number_end(0);
+    if (end == 0)
+        throw fail();
+    double first = fromString<double>(text.substr(0, end));
+    std::size_t at = skip_spaces(end);
+    if (at == text.size())
+        return Complex(first, 0);
+    if (text[at] == 'i' && at + 1 == text.size())
+        return Complex(0, first);
+    if (text[at] != '+' && text[at] != '-')
+        throw fail();
+    double sign = text[at] == '-' ? -1 : 1;
+    at = skip_spaces(at + 1);
+    end = number_end(at);
+    if (end == at || end + 1 != text.size() || text[end] != 'i')
+        throw fail();
+    return Complex(first, sign * fromString<double>(text.substr(at, end - at)));
+}
+
+/**
+ * @brief Parse a CachedComplex from the same forms as Complex.
+ */
+template<>
+inline CachedComplex fromString(std::string_view text) {
+    return CachedComplex(fromString<Complex>(text));
+}
+
+/**
+ * @brief A fixed-size read buffer over an input stream.
+ *
+ * Parsers read one character at a time from the buffer, which is refilled in
+ * blocks, so memory use does not grow with the input size.
+ */
+class StreamReader {
+public:
+    static const std::size_t BUFFER_SIZE = 1 << 16;  ///< Bytes read from the stream per refill.
+
+    /**
+     * @brief Construct a reader over a stream.
+     *
+     * @param in The stream to read from.
+     */
+    explicit StreamReader(std::istream &in) : in(in), buffer(BUFFER_SIZE) {}
+
+    /**
+     * @brief Look at the next character without consuming it.
+     *
+     * @return int The next character, or EOF at the end of the input.
+     */
+    int peek() {
+        if (position == filled && !refill())
+            return EOF;
+        return static_cast<unsigned char>(buffer[position]);
+    }
+
+    /**
+     * @brief Consume the next character.
+     *
+     * @return int The consumed character, or EOF at the end of the input.
+     */
+    int get() {
+        int c = peek();
+        if (c != EOF) {
+            ++position;
+            if (c == '\n')
+                ++line;
+        }
+        return c;
+    }
+
+    /**
+     * @brief Consume spaces, tabs and line breaks.
+     */
+    void skip_whitespace() {
+        for (int c = peek(); c == ' ' || c == '\t' || c == '\n' || c == '\r'; c = peek())
+            get();
+    }
+
+    /**
+     * @brief Get the current line number, for error messages.
+     *
+     * @return std::size_t The 1-based line number.
+     */
+    std::size_t line_number() const {
+        return line;
+    }
+
+    /**
+     * @brief Build an exception pointing at the current line.
+     *
+     * @param message What went wrong.
+     * @return std::invalid_argument The exception to throw.
+     */
+    std::invalid_argument error(const std::string &message) const {
+        return std::invalid_argument("Line " + std::to_string(line) + ": " + message);
+    }
+
+private:
+    std::istream &in;            ///< The stream being read.
+    std::vector<char> buffer;    ///< The current block of input.
+    std::size_t position = 0;    ///< Next unread byte in the buffer.
+    std::size_t filled = 0;      ///< Number of valid bytes in the buffer.
+    std::size_t line = 1;        ///< Current line number.
+
+    /**
+     * @brief Read the next block of input.
+     *
+     * @return true If at least one byte was read.
+     */
+    bool refill() {
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        filled = static_cast<std::size_t>(in.gcount());
+        position = 0;
+        return filled > 0;
+    }
+};
+
+/**
+ * @brief Trim spaces and tabs from both ends of a string view.
+ *
+ * @param text The text to trim.
+ * @return std::string_view The trimmed text.
+ */
+inline std::string_view trim(std::string_view text) {
+    std::size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos)
+        return {};
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+/**
+ * @brief Accumulates parsed nodes as parent and key arrays for Tree::build_from_parent_array.
+ *
+ * @tparam T The type of the keys.
+ * @tparam D The degree of the tree being built.
+ */
+template<typename T, unsigned int D>
+class ParsedNodes {
+public:
+    std::vector<std::size_t> parents;  ///< Parent index of every node, NO_PARENT until linked.
+    std::vector<T> keys;               ///< Key of every node.
+
+    /**
+     * @brief Add a node that is not linked to a parent yet.
+     *
+     * @param key The key of the node.
+     * @return std::size_t The index of the new node.
+     */
+    std::size_t add(T key) {
+        keys.push_back(std::move(key));
+        parents.push_back(Tree<T, D>::NO_PARENT);
+        return keys.size() - 1;
+    }
+
+    /**
+     * @brief Build the tree from the accumulated nodes.
+     *
+     * @return Tree<T, D> The parsed tree.
+     */
+    Tree<T, D> build() const {
+        Tree<T, D> tree;
+        tree.build_from_parent_array(parents, keys);
+        return tree;
+    }
+};
+
+/**
+ * @brief Parse a tree from an edge list.
+ *
+ * Each line holds "parent child"; a line with a single key declares the root,
+ * otherwise the parent of the first edge is the root. Fields are separated by
+ * tabs when the line has one, so keys with spaces such as "5 + 5i" stay
+ * intact, and by whitespace otherwise. Empty lines and lines starting with '#'
+ * are skipped. Parents are resolved to the first node with that key, and must
+ * appear before their children.
+ *
+ * @tparam T The type of the keys; needs std::hash.
+ * @tparam D The degree of the tree.
+ * @param in The stream to read.
+ * @return Tree<T, D> The parsed tree.
+ * @throws std::invalid_argument If a line or key is malformed.
+ * @throws std::logic_error If a parent is not found.
+ */
+template<typename T, unsigned int D = 2>
+Tree<T, D> parse_edge_list(std::istream &in) {
+    StreamReader reader(in);
+    ParsedNodes<T, D> nodes;
+    std::unordered_map<T, std::size_t> index;
+    std::string line;
+    std::size_t line_number = 0;
+    std::vector<std::string_view> fields;
+
+    auto node_for = [&](std::string_view field) {
+        T key = fromString<T>(field);
+        auto found = index.find(key);
+        if (found != index.end())
+            return found->second;
+        if (!nodes.keys.empty())
+            throw std::logic_error("Parent not found.");
+        std::size_t added = nodes.add(key);
+        index.emplace(std::move(key), added);
+        return added;
+    };
+
+    while (reader.peek() != EOF) {
+        line.clear();
+        ++line_number;
+        for (int c = reader.get(); c != EOF && c != '\n'; c = reader.get())
+            line.push_back(static_cast<char>(c));
+        std::string_view text = trim(line);
+        if (text.empty() || text[0] == '#')
+            continue;
+
+        fields.clear();
+        const char *separators = text.find('\t') != std::string_view::npos ? "\t" : " \t";
+        for (std::size_t start = 0; start < text.size();) {
+            std::size_t end = std::min(text.find_first_of(separators, start), text.size());
+            std::string_view field = trim(text.substr(start, end - start));
+            if (!field.empty())
+                fields.push_back(field);
+            start = end + 1;
+        }
+        if (fields.size() == 1) {
+            if (!nodes.keys.empty())
+                throw std::invalid_argument("Line " + std::to_string(line_number) + ": root declared twice.");
+            node_for(fields[0]);
+        } else if (fields.size() == 2) {
+            std::size_t parent = node_for(fields[0]);
+            T key = fromString<T>(fields[1]);
+            std::size_t child = nodes.add(key);
+            nodes.parents[child] = parent;
+            index.emplace(std::move(key), child);
+        } else {
+            throw std::invalid_argument("Line " + std::to_string(line_number) + ": expected \"parent child\".");
+        }
+    }
+    return nodes.build();
+}
+
+/**
+ * @brief Parse a tree in Newick (parenthesized) notation, e.g. "((e)b,(f)c,d)a;".
+ *
+ * Children are listed in parentheses before the label of their parent. Labels
+ * end at one of "(),:;[" and are trimmed, or may be single-quoted, in which
+ * case they are kept exactly, blanks and empty labels included; branch
+ * lengths after ':' and [comments] are ignored. Nesting is handled with an
+ * explicit stack, so arbitrarily deep trees do not recurse.
+ *
+ * @tparam T The type of the keys.
+ * @tparam D The degree of the tree.
+ * @param in The stream to read.
+ * @return Tree<T, D> The parsed tree.
+ * @throws std::invalid_argument If the input is malformed.
+ */
+template<typename T, unsigned int D = 2>
+Tree<T, D> parse_newick(std::istream &in) {
+    StreamReader reader(in);
+    ParsedNodes<T, D> nodes;
+    std::vector<std::size_t> pending;  // finished subtrees whose parent label has not been read yet
+    std::vector<std::size_t> opens;    // start of each open parenthesis' children in pending
+    std::string label;
+    bool has_root = false;
+
+    auto skip_ignored = [&reader]() {
+        while (true) {
+            reader.skip_whitespace();
+            if (reader.peek() != '[')
+                return;
+            while (reader.peek() != EOF && reader.get() != ']') {
+            }
+        }
+    };
+    auto read_label = [&]() {
+        skip_ignored();
+        label.clear();
+        if (reader.peek() == '\'') {
+            reader.get();
+            while (true) {
+                int c = reader.get();
+                if (c == EOF)
+                    throw reader.error("unterminated quoted label.");
+                if (c == '\'') {
+                    if (reader.peek() != '\'')
+                        break;
+                    reader.get();  // '' is an escaped quote
+                }
+                label.push_back(static_cast<char>(c));
+            }
+            return fromString<T>(label);  // kept exactly as quoted, blanks and empty labels included
+        } else {
+            for (int c = reader.peek(); c != EOF && std::string_view("(),:;[").find(static_cast<char>(c)) == std::string_view::npos; c = reader.peek())
+                label.push_back(static_cast<char>(reader.get()));
+        }
+        std::string_view text = trim(label);
+        if (text.empty())
+            throw reader.error("node without a label.");
+        return fromString<T>(text);
+    };
+    auto finish = [&](std::size_t node) {
+        if (!opens.empty()) {
+            pending.push_back(node);
+        } else if (has_root) {
+            throw reader.error("more than one tree; missing ';'?");
+        } else {
+            has_root = true;
+        }
+    };
+
+    skip_ignored();
+    if (reader.peek() == EOF)
+        return Tree<T, D>();
+    bool expect_subtree = true;
+    while (true) {
+        skip_ignored();
+        int c = reader.peek();
+        if (expect_subtree) {
+            if (c == '(') {
+                reader.get();
+                opens.push_back(pending.size());
+                continue;
+            }
+            finish(nodes.add(read_label()));
+            expect_subtree = false;
+            continue;
+        }
+        if (c == ':') {
+            reader.get();
+            skip_ignored();
+            for (c = reader.peek(); c != EOF && std::string_view("(),;[").find(static_cast<char>(c)) == std::string_view::npos; c = reader.peek())
+                reader.get();
+            continue;
+        }
+        if (c == ',') {
+            reader.get();
+            if (opens.empty())
+                throw reader.error("',' outside parentheses.");
+            expect_subtree = true;
+        } else if (c == ')') {
+            reader.get();
+            if (opens.empty())
+                throw reader.error("unbalanced ')'.");
+            std::size_t start = opens.back();
+            opens.pop_back();
+            std::size_t node = nodes.add(read_label());
+            for (std::size_t i = start; i < pending.size(); ++i)
+                nodes.parents[pending[i]] = node;
+            pending.resize(start);
+            finish(node);
+        } else if (c == ';' || c == EOF) {
+            if (!opens.empty())
+                throw reader.error("unbalanced '('.");
+            break;
+        } else {
+            throw reader.error(std::string("unexpected '") + static_cast<char>(c) + "'.");
+        }
+    }
+    return nodes.build();
+}
+
+/**
+ * @brief Parse a tree from nested JSON objects.
+ *
+ * Every node is an object {"key": ..., "children": [...]}; the key may be a
+ * JSON string or number and is converted with fromString, "children" is
+ * optional, members may come in any order and unknown members are skipped.
+ * Nesting is handled with an explicit stack, so arbitrarily deep trees do not
+ * recurse.
+ *
+ * @tparam T The type of the keys.
+ * @tparam D The degree of the tree.
+ * @param in The stream to read.
+ * @return Tree<T, D> The parsed tree.
+ * @throws std::invalid_argument If the input is malformed.
+ */
+template<typename T, unsigned int D = 2>
+Tree<T, D> parse_json(std::istream &in) {
+    StreamReader reader(in);
+    ParsedNodes<T, D> nodes;
+    std::vector<std::size_t> pending;  // finished child nodes whose parent object is still open
+    std::string text;
+
+    /**
+     * An open node object, or an open "children" array when is_array is set.
+     */
+    struct Frame {
+        bool is_array;
+        std::size_t start;         // start of this node's children in pending
+        std::optional<T> key;
+    };
+    std::vector<Frame> stack;
+
+    auto expect = [&reader](char wanted) {
+        reader.skip_whitespace();
+        if (reader.get() != wanted)
+            throw reader.error(std::string("expected '") + wanted + "'.");
+    };
+    auto read_string = [&]() {
+        expect('"');
+        text.clear();
+        while (true) {
+            int c = reader.get();
+            if (c == EOF)
+                throw reader.error("unterminated string.");
+            if (c == '"')
+                return;
+            if (c != '\\') {
+                text.push_back(static_cast<char>(c));
+                continue;
+            }
+            c = reader.get();
+            switch (c) {
+                case 'b': text.push_back('\b'); break;
+                case 'f': text.push_back('\f'); break;
+                case 'n': text.push_back('\n'); break;
+                case 'r': text.push_back('\r'); break;
+                case 't': text.push_back('\t'); break;
+                case 'u': {
+                    unsigned int code = 0;
+                    for (int i = 0; i < 4; ++i) {
+                        int h = reader.get();
+                        code <<= 4;
+                        if (h >= '0' && h <= '9') code |= static_cast<unsigned int>(h - '0');
+                        else if (h >= 'a' && h <= 'f') code |= static_cast<unsigned int>(h - 'a' + 10);
+                        else if (h >= 'A' && h <= 'F') code |= static_cast<unsigned int>(h - 'A' + 10);
+                        else throw reader.error("bad \\u escape.");
+                    }
+                    if (code < 0x80) {
+                        text.push_back(static_cast<char>(code));
+                    } else if (code < 0x800) {
+                        text.push_back(static_cast<char>(0xC0 | (code >> 6)));
+                        text.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                    } else {
+                        text.push_back(static_cast<char>(0xE0 | (code >> 12)));
+                        text.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3F)));
+                        text.push_back(static_cast<char>(0x80 | (code & 0x3F)));
+                    }
+                    break;
+                }
+                case EOF: throw reader.error("unterminated string.");
+                default: text.push_back(static_cast<char>(c)); break;
+            }
+        }
+    };
+    auto read_scalar = [&]() {
+        reader.skip_whitespace();
+        if (reader.peek() == '"') {
+            read_string();
+            return;
+        }
+        text.clear();
+        for (int c = reader.peek(); c != EOF && std::string_view(",}] \t\r\n").find(static_cast<char>(c)) == std::string_view::npos; c = reader.peek())
+            text.push_back(static_cast<char>(reader.get()));
+        if (text.empty())
+            throw reader.error("expected a key value.");
+    };
+    auto skip_value = [&]() {
+        reader.skip_whitespace();
+        int c = reader.peek();
+        if (c != '{' && c != '[') {
+            read_scalar();
+            return;
+        }
+        std::size_t depth = 0;
+        do {
+            c = reader.peek();
+            if (c == EOF)
+                throw reader.error("unterminated value.");
+            if (c == '"') {
+                read_string();
+                continue;
+            }
+            reader.get();
+            if (c == '{' || c == '[')
+                ++depth;
+            else if (c == '}' || c == ']')
+                --depth;
+        } while (depth > 0);
+    };
+
+    reader.skip_whitespace();
+    if (reader.peek() == EOF)
+        return Tree<T, D>();
+    expect('{');
+    stack.push_back(Frame{false, 0, std::nullopt});
+    bool first_item = true;  // nothing read yet in the innermost open object or array
+
+    while (!stack.empty()) {
+        reader.skip_whitespace();
+        Frame &top = stack.back();
+        int c = reader.peek();
+        if (top.is_array) {
+            if (c == ']') {
+                reader.get();
+                stack.pop_back();
+                first_item = false;
+                continue;
+            }
+            if (!first_item)
+                expect(',');
+            expect('{');
+            stack.push_back(Frame{false, pending.size(), std::nullopt});
+            first_item = true;
+            continue;
+        }
+        if (c == '}') {
+            reader.get();
+            if (!top.key)
+                throw reader.error("node without a \"key\".");
+            std::size_t node = nodes.add(std::move(*top.key));
+            for (std::size_t i = top.start; i < pending.size(); ++i)
+                nodes.parents[pending[i]] = node;
+            pending.resize(top.start);
+            stack.pop_back();
+            if (!stack.empty())
+                pending.push_back(node);
+            first_item = false;
+            continue;
+        }
+        if (!first_item)
+            expect(',');
+        read_string();
+        expect(':');
+        first_item = false;
+        if (text == "key") {
+            read_scalar();
+            top.key = fromString<T>(text);
+        } else if (text == "children") {
+            expect('[');
+            stack.push_back(Frame{true, 0, std::nullopt});
+            first_item = true;
+        } else {
+            skip_value();
+        }
+    }
+    reader.skip_whitespace();
+    if (reader.peek() != EOF)
+        throw reader.error("trailing data after the root object.");
+    return nodes.build();
+}
+
+#endif // TREESITERATORS_CPP_TREEPARSER_HPP
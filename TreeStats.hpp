@@ -0,0 +1,170 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_TREESTATS_HPP
+#define TREESITERATORS_CPP_TREESTATS_HPP
+
+#include <cstdint>
+#ifdef TREE_ENABLE_STATS
+#include <atomic>
+#endif
+
+/**
+ * @brief A snapshot of the operation counters of one tree, returned by Tree::stats().
+ *
+ * All fields stay zero unless the code is compiled with TREE_ENABLE_STATS.
+ */
+struct TreeStats {
+    std::uint64_t node_allocations = 0;       ///< Nodes allocated by add_root, add_sub_node(s) and the bulk builders.
+    std::uint64_t traversals = 0;             ///< Traversals started by visit() or the begin_* methods.
+    std::uint64_t nodes_visited = 0;          ///< Nodes produced by all those traversals together.
+    std::uint64_t parent_searches = 0;        ///< add_sub_node(s) calls that searched the parent by value.
+    std::uint64_t parent_search_nodes = 0;    ///< Nodes examined by all those searches together.
+    std::uint64_t longest_parent_search = 0;  ///< Nodes examined by the longest single search.
+    std::uint64_t heap_rebuilds = 0;          ///< Full rebuilds by myHeap, including those from begin_heap.
+    std::uint64_t peak_iterator_buffer = 0;   ///< Most stack frames or queued nodes held by one traversal at once.
+};
+
+#ifdef TREE_ENABLE_STATS
+
+/**
+ * @brief Relaxed atomic counters updated on the tree's hot paths.
+ *
+ * Inserts may run on several threads, so the counters are atomics; they only
+ * need to be exact eventually, so every update is a relaxed operation.
+ */
+class TreeCounters {
+public:
+    TreeCounters() = default;
+
+    /**
+     * @brief Copies of a tree count their own operations, starting from zero.
+     */
+    TreeCounters(const TreeCounters &) {}
+
+    TreeCounters &operator=(const TreeCounters &) {
+        return *this;
+    }
+
+    /**
+     * @brief Count allocated nodes.
+     *
+     * @param count The number of nodes.
+     */
+    void allocated(std::uint64_t count) {
+        node_allocations.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Count a started traversal.
+     */
+    void traversal_started() {
+        traversals.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Count nodes produced by a traversal.
+     *
+     * @param count The number of nodes.
+     */
+    void visited(std::uint64_t count) {
+        nodes_visited.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Record how many nodes a traversal holds at once.
+     *
+     * @param pending The number of stack frames or queued nodes.
+     */
+    void buffered(std::uint64_t pending) {
+        raise(peak_iterator_buffer, pending);
+    }
+
+    /**
+     * @brief Count a search for a parent by value.
+     *
+     * @param examined The number of nodes compared with the value.
+     */
+    void searched(std::uint64_t examined) {
+        parent_searches.fetch_add(1, std::memory_order_relaxed);
+        parent_search_nodes.fetch_add(examined, std::memory_order_relaxed);
+        raise(longest_parent_search, examined);
+    }
+
+    /**
+     * @brief Count a heap rebuild.
+     */
+    void rebuilt_heap() {
+        heap_rebuilds.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Read all counters.
+     *
+     * @return TreeStats The current values.
+     */
+    TreeStats snapshot() const {
+        TreeStats stats;
+        stats.node_allocations = node_allocations.load(std::memory_order_relaxed);
+        stats.traversals = traversals.load(std::memory_order_relaxed);
+        stats.nodes_visited = nodes_visited.load(std::memory_order_relaxed);
+        stats.parent_searches = parent_searches.load(std::memory_order_relaxed);
+        stats.parent_search_nodes = parent_search_nodes.load(std::memory_order_relaxed);
+        stats.longest_parent_search = longest_parent_search.load(std::memory_order_relaxed);
+        stats.heap_rebuilds = heap_rebuilds.load(std::memory_order_relaxed);
+        stats.peak_iterator_buffer = peak_iterator_buffer.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    /**
+     * @brief Set all counters back to zero.
+     */
+    void reset() {
+        for (auto *counter : {&node_allocations, &traversals, &nodes_visited, &parent_searches,
+                              &parent_search_nodes, &longest_parent_search, &heap_rebuilds, &peak_iterator_buffer}) {
+            counter->store(0, std::memory_order_relaxed);
+        }
+    }
+
+private:
+    std::atomic<std::uint64_t> node_allocations{0};
+    std::atomic<std::uint64_t> traversals{0};
+    std::atomic<std::uint64_t> nodes_visited{0};
+    std::atomic<std::uint64_t> parent_searches{0};
+    std::atomic<std::uint64_t> parent_search_nodes{0};
+    std::atomic<std::uint64_t> longest_parent_search{0};
+    std::atomic<std::uint64_t> heap_rebuilds{0};
+    std::atomic<std::uint64_t> peak_iterator_buffer{0};
+
+    /**
+     * @brief Raise a maximum counter to at least a value.
+     */
+    static void raise(std::atomic<std::uint64_t> &maximum, std::uint64_t value) {
+        std::uint64_t current = maximum.load(std::memory_order_relaxed);
+        while (current < value && !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        }
+    }
+};
+
+#else
+
+/**
+ * @brief Stand-in for the counters when TREE_ENABLE_STATS is not defined.
+ *
+ * Every method is an empty inline function, so the calls on the hot paths
+ * compile to nothing.
+ */
+class TreeCounters {
+public:
+    void allocated(std::uint64_t) {}
+    void traversal_started() {}
+    void visited(std::uint64_t) {}
+    void buffered(std::uint64_t) {}
+    void searched(std::uint64_t) {}
+    void rebuilt_heap() {}
+    TreeStats snapshot() const { return TreeStats(); }
+    void reset() {}
+};
+
+#endif // TREE_ENABLE_STATS
+
+#endif // TREESITERATORS_CPP_TREESTATS_HPP
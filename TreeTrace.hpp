@@ -0,0 +1,199 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_TREETRACE_HPP
+#define TREESITERATORS_CPP_TREETRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+/**
+ * @brief Receives the timing spans emitted by Tree and GUI.
+ *
+ * Spans are reported from whichever thread ran the operation, so
+ * implementations must be thread-safe.
+ */
+class TraceSink {
+public:
+    virtual ~TraceSink() = default;
+
+    /**
+     * @brief Record one finished operation.
+     *
+     * @param name The operation, e.g. "traverse_bfs_scan"; a string literal.
+     * @param start_us Start time in microseconds on the steady clock.
+     * @param duration_us Duration in microseconds.
+     * @param nodes The number of tree nodes the operation handled.
+     */
+    virtual void span(const char *name, double start_us, double duration_us, std::size_t nodes) = 0;
+};
+
+/**
+ * @brief Writes spans as Chrome trace-event JSON, viewable in chrome://tracing or Perfetto.
+ *
+ * Every span becomes a complete ("ph":"X") event with the node count in its
+ * args. The file is a valid JSON object once the writer is destroyed.
+ */
+class ChromeTraceWriter : public TraceSink {
+public:
+    /**
+     * @brief Open the trace file.
+     *
+     * @param path The file to write.
+     * @throws std::runtime_error If the file cannot be opened.
+     */
+    explicit ChromeTraceWriter(const std::string &path) : out(path) {
+        if (!out) {
+            throw std::runtime_error("Cannot open trace file " + path + ".");
+        }
+        out.setf(std::ios::fixed);
+        out.precision(3);  // microseconds with nanosecond digits
+        out << "{\"traceEvents\":[";
+    }
+
+    ChromeTraceWriter(const ChromeTraceWriter &) = delete;
+    ChromeTraceWriter &operator=(const ChromeTraceWriter &) = delete;
+
+    /**
+     * @brief Close the event array and the file.
+     */
+    ~ChromeTraceWriter() override {
+        out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+    }
+
+    void span(const char *name, double start_us, double duration_us, std::size_t nodes) override {
+        unsigned int tid = thread_index();
+        std::lock_guard<std::mutex> guard(mutex);
+        out << (first ? "\n" : ",\n") << "{\"name\":\"" << name << "\",\"cat\":\"tree\",\"ph\":\"X\",\"ts\":"
+            << start_us << ",\"dur\":" << duration_us << ",\"pid\":1,\"tid\":" << tid
+            << ",\"args\":{\"nodes\":" << nodes << "}}";
+        first = false;
+    }
+
+private:
+    std::ofstream out;
+    std::mutex mutex;    ///< Serializes writers from several threads.
+    bool first = true;   ///< Whether no event has been written yet.
+
+    /**
+     * @brief Small, stable id of the calling thread for the tid field.
+     */
+    static unsigned int thread_index() {
+        static std::atomic<unsigned int> next{0};
+        thread_local unsigned int index = next.fetch_add(1, std::memory_order_relaxed);
+        return index;
+    }
+};
+
+#ifdef TREE_ENABLE_TRACING
+
+/**
+ * @brief The sink all spans go to; null disables tracing at run time.
+ */
+inline std::atomic<TraceSink *> &trace_sink_slot() {
+    static std::atomic<TraceSink *> sink{nullptr};
+    return sink;
+}
+
+/**
+ * @brief Route the spans of all trees and GUIs to a sink.
+ *
+ * @param sink The sink, or null to stop tracing. It must outlive every traced operation.
+ */
+inline void set_trace_sink(TraceSink *sink) {
+    trace_sink_slot().store(sink, std::memory_order_release);
+}
+
+/**
+ * @brief Times a scope and reports it to the installed sink.
+ *
+ * When no sink is installed the span only reads one atomic pointer. The
+ * node count is atomic, so copies of a traced iterator that share one span
+ * may advance on different threads, e.g. under a parallel algorithm.
+ */
+class TraceSpan {
+public:
+    /**
+     * @brief Start timing.
+     *
+     * @param name The operation name; must be a string literal.
+     * @param nodes The node count, if already known.
+     */
+    explicit TraceSpan(const char *name, std::size_t nodes = 0)
+        : sink(trace_sink_slot().load(std::memory_order_acquire)), name(name), nodes(nodes) {
+        if (sink)
+            start = now_us();
+    }
+
+    TraceSpan(const TraceSpan &) = delete;
+    TraceSpan &operator=(const TraceSpan &) = delete;
+
+    /**
+     * @brief Set the node count reported with the span.
+     *
+     * @param count The number of nodes the operation handled.
+     */
+    void set_nodes(std::size_t count) {
+        nodes.store(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Add to the node count reported with the span.
+     *
+     * @param count The number of further nodes handled.
+     */
+    void add_nodes(std::size_t count) {
+        nodes.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Whether a sink was installed when the span started.
+     */
+    bool active() const {
+        return sink != nullptr;
+    }
+
+    /**
+     * @brief Stop timing and report the span.
+     */
+    ~TraceSpan() {
+        if (sink)
+            sink->span(name, start, now_us() - start, nodes.load(std::memory_order_relaxed));
+    }
+
+private:
+    TraceSink *sink;
+    const char *name;
+    std::atomic<std::size_t> nodes;  ///< Updated by every copy of a traced iterator, possibly concurrently.
+    double start = 0;
+
+    static double now_us() {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+#else
+
+/**
+ * @brief Stand-in for TraceSpan when TREE_ENABLE_TRACING is not defined; compiles to nothing.
+ */
+class TraceSpan {
+public:
+    explicit TraceSpan(const char *, std::size_t = 0) {}
+    void set_nodes(std::size_t) {}
+    void add_nodes(std::size_t) {}
+    bool active() const { return false; }
+};
+
+/**
+ * @brief Without TREE_ENABLE_TRACING no spans are emitted, so the sink is ignored.
+ */
+inline void set_trace_sink(TraceSink *) {}
+
+#endif // TREE_ENABLE_TRACING
+
+#endif // TREESITERATORS_CPP_TREETRACE_HPP
@@ -0,0 +1,983 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_TREETRAVERSAL_HPP
+#define TREESITERATORS_CPP_TREETRAVERSAL_HPP
+
+#include <cstddef>
+#include <deque>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#if __cplusplus >= 202002L && __has_include(<ranges>)
+#include <ranges>
+#endif
+
+/**
+ * @brief Order tags selecting a traversal at compile time, e.g. tree.visit<PostOrder>(visitor).
+ */
+struct PreOrder {};      ///< The node, then its children left to right.
+struct PostOrder {};     ///< The children left to right, then the node.
+struct BreadthFirst {};  ///< Level by level, left to right.
+struct DepthFirst {};    ///< Depth-first scan, the same order as pre-order.
+struct ReversePreOrder {};      ///< Pre-order backwards: the children right to left, each reversed, then the node.
+struct ReversePostOrder {};     ///< Post-order backwards: the node, then the children right to left, each reversed.
+struct ReverseBreadthFirst {};  ///< Breadth-first backwards: the deepest level first, each level right to left.
+
+/**
+ * @brief Where a depth-first cursor reports a node: after this many of its children.
+ */
+struct SplitBefore {
+    static constexpr bool MIRRORED = false;  ///< Whether the children are entered right to left.
+    static std::size_t at(std::size_t) { return 0; }
+};
+
+/**
+ * @brief Report a node after all of its children.
+ */
+struct SplitAfter {
+    static constexpr bool MIRRORED = false;
+    static std::size_t at(std::size_t children) { return children; }
+};
+
+/**
+ * @brief Report a node after the first half of its children, rounded up: ceil(k/2) of k.
+ *
+ * On binary trees this is the usual left child, node, right child; a lone
+ * child counts as a left child. On a D-ary search tree whose keys grow from
+ * the left children over the node to the right ones it gives sorted output.
+ */
+struct SplitHalf {
+    static constexpr bool MIRRORED = false;
+    static std::size_t at(std::size_t children) { return (children + 1) / 2; }
+};
+
+/**
+ * @brief Report a node after its first N children, or after all of them if it has fewer.
+ *
+ * @tparam N The number of children before the node.
+ */
+template<std::size_t N>
+struct SplitAt {
+    static constexpr bool MIRRORED = false;
+    static std::size_t at(std::size_t children) { return children < N ? children : N; }
+};
+
+/**
+ * @brief In-order with a chosen split, e.g. tree.visit<InOrderWith<SplitAt<2>>>(visitor).
+ *
+ * @tparam Split The split policy; the default reports a node after ceil(k/2) of its k children.
+ */
+template<typename Split = SplitHalf>
+struct InOrderWith {};
+
+using InOrder = InOrderWith<>;  ///< The first half of the children, the node, then the rest.
+
+/**
+ * @brief Enter the children right to left, reporting a node after Split::at(children) of them.
+ *
+ * Mirroring post-order gives reverse pre-order and vice versa.
+ */
+template<typename Split>
+struct Mirrored {
+    static constexpr bool MIRRORED = true;
+    static std::size_t at(std::size_t children) { return Split::at(children); }
+};
+
+/**
+ * @brief Get the split point of a policy whose at() looks at the node itself, e.g. at its key.
+ */
+template<typename Split, typename Node>
+auto split_of(const Node &node, int) -> decltype(Split::at(node)) {
+    return Split::at(node);
+}
+
+/**
+ * @brief Get the split point of a policy whose at() only needs the number of children.
+ */
+template<typename Split, typename Node>
+std::size_t split_of(const Node &node, long) {
+    return Split::at(node.children.size());
+}
+
+/**
+ * @brief Get the number of children a node is reported after, under a split policy.
+ *
+ * Policies define either at(std::size_t children) or at(const Node &node).
+ *
+ * @param node The node.
+ */
+template<typename Split, typename Node>
+std::size_t split_of(const Node &node) {
+    return split_of<Split>(node, 0);
+}
+
+/**
+ * @brief Get the index of the child a split policy enters in a given step.
+ *
+ * @param step The number of children entered before.
+ * @param children The number of children.
+ */
+template<typename Split>
+std::size_t split_child(std::size_t step, std::size_t children) {
+    return Split::MIRRORED ? children - 1 - step : step;
+}
+
+/**
+ * @brief Order tag for a traversal that stops at a maximum depth and skips subtrees, e.g. Pruned<DepthFirst, Skip>.
+ *
+ * @tparam Order The underlying order tag.
+ * @tparam Skip Predicate called as skip(const Node &node); true leaves out the node and its whole subtree.
+ */
+template<typename Order, typename Skip>
+struct Pruned {};
+
+/**
+ * @brief Skip predicate of a traversal that is only limited in depth.
+ */
+struct SkipNone {
+    template<typename Node>
+    bool operator()(const Node &) const { return false; }
+};
+
+/**
+ * @brief Pruning policy of the unpruned traversals; enters every node and compiles away.
+ */
+struct NoPruning {
+    template<typename Node>
+    bool enters(const Node &, std::size_t) const { return true; }
+};
+
+/**
+ * @brief Pruning policy of a Pruned traversal: a maximum depth and a skip predicate.
+ *
+ * The predicate is shared by the copies of an iterator, so iterators stay
+ * copy-assignable even when it is a lambda with captures.
+ *
+ * @tparam Skip The skip predicate.
+ */
+template<typename Skip>
+class Pruning {
+public:
+    /**
+     * @brief Construct the policy of an exhausted cursor.
+     */
+    Pruning() = default;
+
+    /**
+     * @brief Construct a policy.
+     *
+     * @param max_depth The deepest level entered; the root is at depth 0.
+     * @param skip Called before a node is entered; true skips its subtree.
+     */
+    Pruning(std::size_t max_depth, Skip skip) : max_depth(max_depth), skip(std::make_shared<const Skip>(std::move(skip))) {}
+
+    /**
+     * @brief Check whether a traversal enters a node.
+     *
+     * @param node The node.
+     * @param depth Its depth.
+     * @return true If the node and then its children should be visited.
+     */
+    template<typename Node>
+    bool enters(const Node &node, std::size_t depth) const {
+        return depth <= max_depth && !(*skip)(node);
+    }
+
+private:
+    std::size_t max_depth = 0;          ///< The deepest level entered.
+    std::shared_ptr<const Skip> skip;   ///< The skip predicate.
+};
+
+/**
+ * @brief Lazy depth-first traversal over shared_ptr-linked nodes.
+ *
+ * Keeps one (node, next child) frame per level on an explicit stack, so
+ * memory is proportional to the depth and deep trees cannot overflow the
+ * call stack. A node is reported once Split::at(children) of its children
+ * have been finished, which covers pre-, post- and in-order with one loop.
+ * Children the Prune policy rejects are never pushed, so a pruned subtree
+ * costs one check however large it is.
+ *
+ * @tparam Node The node type, with a children vector of std::shared_ptr<Node>.
+ * @tparam Split The split policy.
+ * @tparam Prune The pruning policy.
+ */
+template<typename Node, typename Split, typename Prune = NoPruning>
+class DepthFirstCursor {
+public:
+    /**
+     * @brief Construct an exhausted cursor, used as the end position.
+     */
+    DepthFirstCursor() = default;
+
+    /**
+     * @brief Start at a root.
+     *
+     * @param root Pointer to the shared_ptr owning the root; null or empty for an empty traversal.
+     * @param prune The pruning policy.
+     */
+    explicit DepthFirstCursor(const std::shared_ptr<Node> *root, Prune prune = Prune()) : prune(std::move(prune)) {
+        if (root && *root && this->prune.enters(**root, 0)) {
+            stack.push_back(Frame{root, 0, false});
+            settle();
+        }
+    }
+
+    /**
+     * @brief Get the current node.
+     *
+     * @return const std::shared_ptr<Node>* The shared_ptr owning the current node, null at the end.
+     */
+    const std::shared_ptr<Node> *current() const {
+        return stack.empty() ? nullptr : stack.back().handle;
+    }
+
+    /**
+     * @brief Move to the next node.
+     */
+    void advance() {
+        settle();
+    }
+
+    /**
+     * @brief Get the number of frames held, i.e. the depth of the current node plus one.
+     */
+    std::size_t pending() const {
+        return stack.size();
+    }
+
+private:
+    /**
+     * @brief One node on the path from the root to the current node.
+     */
+    struct Frame {
+        const std::shared_ptr<Node> *handle;  ///< The node, as stored in its parent.
+        std::size_t next;                     ///< Number of children entered so far.
+        bool reported;                        ///< Whether the node has been the current node.
+    };
+
+    std::vector<Frame> stack;  ///< The path to the current node; the top is current once settled.
+    Prune prune;               ///< Decides which children are entered.
+
+    /**
+     * @brief Walk until the top frame is due to be reported, or the traversal ends.
+     */
+    void settle() {
+        while (!stack.empty()) {
+            Frame &top = stack.back();
+            const auto &children = (*top.handle)->children;
+            if (!top.reported && top.next >= split_of<Split>(**top.handle)) {
+                top.reported = true;
+                return;
+            }
+            if (top.next < children.size()) {
+                const std::shared_ptr<Node> *child = &children[split_child<Split>(top.next++, children.size())];
+                if (!prune.enters(**child, stack.size()))
+                    continue;
+                stack.push_back(Frame{child, 0, false});  // invalidates top
+                continue;
+            }
+            stack.pop_back();
+        }
+    }
+};
+
+/**
+ * @brief Lazy breadth-first traversal over shared_ptr-linked nodes.
+ *
+ * The queue only holds the frontier between the current level and the
+ * next, never the whole tree.
+ *
+ * @tparam Node The node type, with a children vector of std::shared_ptr<Node>.
+ */
+template<typename Node>
+class BreadthFirstCursor {
+public:
+    /**
+     * @brief Construct an exhausted cursor, used as the end position.
+     */
+    BreadthFirstCursor() = default;
+
+    /**
+     * @brief Start at a root.
+     *
+     * @param root Pointer to the shared_ptr owning the root; null or empty for an empty traversal.
+     */
+    explicit BreadthFirstCursor(const std::shared_ptr<Node> *root) {
+        if (root && *root)
+            queue.push_back(root);
+    }
+
+    /**
+     * @brief Get the current node.
+     *
+     * @return const std::shared_ptr<Node>* The shared_ptr owning the current node, null at the end.
+     */
+    const std::shared_ptr<Node> *current() const {
+        return queue.empty() ? nullptr : queue.front();
+    }
+
+    /**
+     * @brief Move to the next node, queueing the children of the current one.
+     */
+    void advance() {
+        const std::shared_ptr<Node> *node = queue.front();
+        queue.pop_front();
+        for (const auto &child : (*node)->children) {
+            queue.push_back(&child);
+        }
+    }
+
+    /**
+     * @brief Get the number of queued nodes, including the current one.
+     */
+    std::size_t pending() const {
+        return queue.size();
+    }
+
+private:
+    std::deque<const std::shared_ptr<Node> *> queue;  ///< The current node first, then the frontier.
+};
+
+/**
+ * @brief Marks a cursor constructed at its end position but still knowing the root, so it can step back.
+ */
+struct PastEnd {};
+
+/**
+ * @brief Lazy in-order traversal that can step both ways.
+ *
+ * Holds the path from the root to the current node, with the child index
+ * taken at every ancestor. A node is reported after Split::at(children) of
+ * its children; stepping forwards or backwards moves along the path, so a
+ * full sweep in either direction is amortized O(1) per node and memory is
+ * proportional to the depth.
+ *
+ * @tparam Node The node type, with a children vector of std::shared_ptr<Node>.
+ * @tparam Split The split policy.
+ */
+template<typename Node, typename Split>
+class InOrderCursor {
+public:
+    /**
+     * @brief Construct an exhausted cursor, used as the end position.
+     */
+    InOrderCursor() = default;
+
+    /**
+     * @brief Start at the first node.
+     *
+     * @param root Pointer to the shared_ptr owning the root; null or empty for an empty traversal.
+     */
+    explicit InOrderCursor(const std::shared_ptr<Node> *root) : root(root && *root ? root : nullptr) {
+        if (this->root) {
+            path.push_back(Frame{this->root, 0});
+            descend_first();
+        }
+    }
+
+    /**
+     * @brief Start past the last node, from where retreat() reaches the last node.
+     *
+     * @param root Pointer to the shared_ptr owning the root; null or empty for an empty traversal.
+     */
+    InOrderCursor(const std::shared_ptr<Node> *root, PastEnd) : root(root && *root ? root : nullptr) {}
+
+    /**
+     * @brief Start at the first node for which below(node) is false, like std::partition_point.
+     *
+     * The in-order must be partitioned by the predicate, as in a search tree,
+     * and every node must have at most one child on each side of its split,
+     * as in a binary tree; the cursor then descends a single path, in O(depth).
+     *
+     * @param root Pointer to the shared_ptr owning the root; null or empty for an empty traversal.
+     * @param below Called as below(const Node &node); true for the nodes before the sought position.
+     */
+    template<typename Below>
+    InOrderCursor(const std::shared_ptr<Node> *root, Below below) : root(root && *root ? root : nullptr) {
+        if (!this->root)
+            return;
+        path.push_back(Frame{this->root, 0});
+        std::size_t found = 0;  // length of the path to the best candidate so far, 0 for none
+        while (true) {
+            const Node &node = **path.back().handle;
+            std::size_t split = split_of<Split>(node);
+            if (below(node)) {
+                if (split == node.children.size())
+                    break;
+                enter(split);
+            } else {
+                found = path.size();
+                if (split == 0)
+                    break;
+                enter(split - 1);
+            }
+        }
+        path.resize(found);
+    }
+
+    /**
+     * @brief Get the current node.
+     *
+     * @return const std::shared_ptr<Node>* The shared_ptr owning the current node, null at the end.
+     */
+    const std::shared_ptr<Node> *current() const {
+        return path.empty() ? nullptr : path.back().handle;
+    }
+
+    /**
+     * @brief Move to the next node.
+     */
+    void advance() {
+        const Node &node = **path.back().handle;
+        std::size_t split = split_of<Split>(node);
+        if (split < node.children.size()) {
+            enter(split);
+            descend_first();
+            return;
+        }
+        while (true) {
+            path.pop_back();
+            if (path.empty())
+                return;
+            std::size_t from = path.back().child;
+            const Node &parent = **path.back().handle;
+            if (from + 1 == split_of<Split>(parent))
+                return;  // the left part is done, so the parent is next
+            if (from + 1 < parent.children.size()) {
+                enter(from + 1);
+                descend_first();
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Move to the previous node; from the end position, to the last node.
+     */
+    void retreat() {
+        if (path.empty()) {
+            if (root) {
+                path.push_back(Frame{root, 0});
+                descend_last();
+            }
+            return;
+        }
+        std::size_t split = split_of<Split>(**path.back().handle);
+        if (split > 0) {
+            enter(split - 1);
+            descend_last();
+            return;
+        }
+        while (true) {
+            path.pop_back();
+            if (path.empty())
+                return;
+            std::size_t from = path.back().child;
+            if (from == split_of<Split>(**path.back().handle))
+                return;  // the right part started here, so the parent comes before
+            if (from > 0) {
+                enter(from - 1);
+                descend_last();
+                return;
+            }
+        }
+    }
+
+    /**
+     * @brief Get the number of frames held, i.e. the depth of the current node plus one.
+     */
+    std::size_t pending() const {
+        return path.size();
+    }
+
+private:
+    /**
+     * @brief One node on the path from the root to the current node.
+     */
+    struct Frame {
+        const std::shared_ptr<Node> *handle;  ///< The node, as stored in its parent.
+        std::size_t child;                    ///< The child the path continues into, below the top.
+    };
+
+    const std::shared_ptr<Node> *root = nullptr;  ///< The root, kept to step back from the end.
+    std::vector<Frame> path;                      ///< The root first, the current node last.
+
+    /**
+     * @brief Extend the path into a child of the top node.
+     */
+    void enter(std::size_t index) {
+        path.back().child = index;
+        const std::shared_ptr<Node> *child = &(*path.back().handle)->children[index];
+        path.push_back(Frame{child, 0});
+    }
+
+    /**
+     * @brief Walk down to the first node of the top node's subtree.
+     */
+    void descend_first() {
+        while (split_of<Split>(**path.back().handle) > 0) {
+            enter(0);
+        }
+    }
+
+    /**
+     * @brief Walk down to the last node of the top node's subtree.
+     */
+    void descend_last() {
+        while (true) {
+            std::size_t count = (*path.back().handle)->children.size();
+            if (split_of<Split>(**path.back().handle) == count)
+                return;
+            enter(count - 1);
+        }
+    }
+};
+
+/**
+ * @brief Breadth-first traversal from the last node back to the root.
+ *
+ * The deepest level has to come first, so the cursor records the
+ * breadth-first order as an array of pointers when it starts, using the
+ * array itself as the queue, and then walks it backwards. The array is
+ * shared by copies of the cursor.
+ *
+ * @tparam Node The node type, with a children vector of std::shared_ptr<Node>.
+ */
+template<typename Node>
+class ReverseBreadthFirstCursor {
+public:
+    /**
+     * @brief Construct an exhausted cursor, used as the end position.
+     */
+    ReverseBreadthFirstCursor() = default;
+
+    /**
+     * @brief Record the breadth-first order and start at its last node.
+     *
+     * @param root Pointer to the shared_ptr owning the root; null or empty for an empty traversal.
+     */
+    explicit ReverseBreadthFirstCursor(const std::shared_ptr<Node> *root) {
+        if (!root || !*root)
+            return;
+        auto nodes = std::make_shared<std::vector<const std::shared_ptr<Node> *>>(1, root);
+        for (std::size_t i = 0; i < nodes->size(); ++i) {
+            const std::shared_ptr<Node> *node = (*nodes)[i];
+            for (const auto &child : (*node)->children) {
+                nodes->push_back(&child);
+            }
+        }
+        remaining = nodes->size();
+        order = std::move(nodes);
+    }
+
+    /**
+     * @brief Get the current node.
+     *
+     * @return const std::shared_ptr<Node>* The shared_ptr owning the current node, null at the end.
+     */
+    const std::shared_ptr<Node> *current() const {
+        return remaining ? (*order)[remaining - 1] : nullptr;
+    }
+
+    /**
+     * @brief Move to the previous node in breadth-first order.
+     */
+    void advance() {
+        --remaining;
+    }
+
+    /**
+     * @brief Get the number of recorded nodes.
+     */
+    std::size_t pending() const {
+        return order ? order->size() : 0;
+    }
+
+private:
+    std::shared_ptr<const std::vector<const std::shared_ptr<Node> *>> order;  ///< The breadth-first order.
+    std::size_t remaining = 0;                                                ///< Nodes not yet passed.
+};
+
+/**
+ * @brief The iterator category of a traversal: bidirectional if its cursor can retreat, else forward.
+ */
+template<typename Cursor, typename = void>
+struct CursorCategory {
+    using type = std::forward_iterator_tag;
+};
+
+template<typename Cursor>
+struct CursorCategory<Cursor, decltype(std::declval<Cursor &>().retreat())> {
+    using type = std::bidirectional_iterator_tag;
+};
+
+/**
+ * @brief Lazy breadth-first traversal that tracks the depth of every queued node, for pruning.
+ *
+ * @tparam Node The node type, with a children vector of std::shared_ptr<Node>.
+ * @tparam Prune The pruning policy.
+ */
+template<typename Node, typename Prune>
+class PrunedBreadthFirstCursor {
+public:
+    /**
+     * @brief Construct an exhausted cursor, used as the end position.
+     */
+    PrunedBreadthFirstCursor() = default;
+
+    /**
+     * @brief Start at a root.
+     *
+     * @param root Pointer to the shared_ptr owning the root; null or empty for an empty traversal.
+     * @param prune The pruning policy.
+     */
+    PrunedBreadthFirstCursor(const std::shared_ptr<Node> *root, Prune prune) : prune(std::move(prune)) {
+        if (root && *root && this->prune.enters(**root, 0))
+            queue.push_back(Entry{root, 0});
+    }
+
+    /**
+     * @brief Get the current node.
+     *
+     * @return const std::shared_ptr<Node>* The shared_ptr owning the current node, null at the end.
+     */
+    const std::shared_ptr<Node> *current() const {
+        return queue.empty() ? nullptr : queue.front().handle;
+    }
+
+    /**
+     * @brief Get the depth of the current node.
+     */
+    std::size_t depth() const {
+        return queue.front().depth;
+    }
+
+    /**
+     * @brief Move to the next node, queueing the children of the current one that are entered.
+     */
+    void advance() {
+        Entry entry = queue.front();
+        queue.pop_front();
+        for (const auto &child : (*entry.handle)->children) {
+            if (prune.enters(*child, entry.depth + 1))
+                queue.push_back(Entry{&child, entry.depth + 1});
+        }
+    }
+
+    /**
+     * @brief Get the number of queued nodes, including the current one.
+     */
+    std::size_t pending() const {
+        return queue.size();
+    }
+
+private:
+    /**
+     * @brief A queued node and its depth.
+     */
+    struct Entry {
+        const std::shared_ptr<Node> *handle;  ///< The node, as stored in its parent.
+        std::size_t depth;                    ///< Its depth; the root is at 0.
+    };
+
+    std::deque<Entry> queue;  ///< The current node first, then the frontier.
+    Prune prune;              ///< Decides which children are queued.
+};
+
+/**
+ * @brief One level of a tree: its depth and its nodes left to right, stored contiguously.
+ *
+ * A non-owning view into the LevelCursor that produced it, valid until the
+ * cursor advances. The nodes are plain pointers in an array, so a whole level
+ * can be handed to a vectorized loop or a parallel algorithm.
+ *
+ * @tparam Node The node type.
+ */
+template<typename Node>
+class TreeLevel {
+public:
+    TreeLevel() = default;
+
+    /**
+     * @brief Construct a view of a level.
+     *
+     * @param depth The depth of the level, 0 for the root.
+     * @param nodes The first of the level's nodes.
+     * @param count The number of nodes.
+     */
+    TreeLevel(std::size_t depth, Node *const *nodes, std::size_t count) : level(depth), nodes(nodes), count(count) {}
+
+    /**
+     * @brief Get the depth of the level, 0 for the root.
+     */
+    std::size_t depth() const {
+        return level;
+    }
+
+    /**
+     * @brief Get the number of nodes on the level.
+     */
+    std::size_t size() const {
+        return count;
+    }
+
+    /**
+     * @brief Check whether the level has no nodes.
+     */
+    bool empty() const {
+        return count == 0;
+    }
+
+    /**
+     * @brief Get the node at an index, counted from the left.
+     */
+    Node *operator[](std::size_t index) const {
+        return nodes[index];
+    }
+
+    /**
+     * @brief Get the contiguous array of the level's nodes.
+     */
+    Node *const *data() const {
+        return nodes;
+    }
+
+    Node *const *begin() const {
+        return nodes;
+    }
+
+    Node *const *end() const {
+        return nodes + count;
+    }
+
+private:
+    std::size_t level = 0;          ///< The depth of the level.
+    Node *const *nodes = nullptr;   ///< The nodes, left to right.
+    std::size_t count = 0;          ///< The number of nodes.
+};
+
+/**
+ * @brief Lazy breadth-first traversal that advances a whole level at a time.
+ *
+ * The same queue discipline as BreadthFirstCursor, but the frontier is kept
+ * as two arrays, the current level and the next, so each level is available
+ * as one contiguous TreeLevel together with its depth.
+ *
+ * @tparam Node The node type, with a children vector of std::shared_ptr<Node>.
+ */
+template<typename Node>
+class LevelCursor {
+public:
+    /**
+     * @brief Construct an exhausted cursor, used as the end position.
+     */
+    LevelCursor() = default;
+
+    /**
+     * @brief Start at a root.
+     *
+     * @param root Pointer to the shared_ptr owning the root; null or empty for an empty traversal.
+     */
+    explicit LevelCursor(const std::shared_ptr<Node> *root) {
+        if (root && *root)
+            nodes.push_back(root->get());
+    }
+
+    /**
+     * @brief Get the current level.
+     *
+     * @return TreeLevel<Node> The level, empty at the end; valid until the cursor advances.
+     */
+    TreeLevel<Node> current() const {
+        return TreeLevel<Node>(depth, nodes.data(), nodes.size());
+    }
+
+    /**
+     * @brief Check whether the traversal has ended.
+     */
+    bool done() const {
+        return nodes.empty();
+    }
+
+    /**
+     * @brief Move to the next level, gathering the children of the current one.
+     */
+    void advance() {
+        next.clear();
+        for (Node *node : nodes) {
+            for (const auto &child : node->children) {
+                next.push_back(child.get());
+            }
+        }
+        nodes.swap(next);
+        depth = nodes.empty() ? 0 : depth + 1;
+    }
+
+    /**
+     * @brief Get the number of nodes on the current level.
+     */
+    std::size_t pending() const {
+        return nodes.size();
+    }
+
+private:
+    std::vector<Node *> nodes;  ///< The current level.
+    std::vector<Node *> next;   ///< Scratch for the next level, reused to avoid reallocating.
+    std::size_t depth = 0;      ///< The depth of the current level; 0 once exhausted.
+};
+
+/**
+ * @brief Maps an order tag and tree degree to its cursor type and span name.
+ *
+ * @tparam Order One of the order tags.
+ * @tparam D The degree of the tree.
+ */
+template<typename Order, unsigned int D>
+struct OrderTraits;
+
+template<unsigned int D>
+struct OrderTraits<PreOrder, D> {
+    using Split = SplitBefore;
+    template<typename Node>
+    using Cursor = DepthFirstCursor<Node, Split>;
+    static constexpr const char *NAME = "traverse_pre_order";
+};
+
+template<unsigned int D>
+struct OrderTraits<PostOrder, D> {
+    using Split = SplitAfter;
+    template<typename Node>
+    using Cursor = DepthFirstCursor<Node, Split>;
+    static constexpr const char *NAME = "traverse_post_order";
+};
+
+template<typename InSplit, unsigned int D>
+struct OrderTraits<InOrderWith<InSplit>, D> {
+    using Split = InSplit;
+    template<typename Node>
+    using Cursor = InOrderCursor<Node, Split>;
+    static constexpr const char *NAME = "traverse_in_order";
+};
+
+template<unsigned int D>
+struct OrderTraits<BreadthFirst, D> {
+    template<typename Node>
+    using Cursor = BreadthFirstCursor<Node>;
+    static constexpr const char *NAME = "traverse_bfs_scan";
+};
+
+template<unsigned int D>
+struct OrderTraits<DepthFirst, D> {
+    using Split = SplitBefore;
+    template<typename Node>
+    using Cursor = DepthFirstCursor<Node, Split>;
+    static constexpr const char *NAME = "traverse_dfs_scan";
+};
+
+template<unsigned int D>
+struct OrderTraits<ReversePreOrder, D> {
+    using Split = Mirrored<SplitAfter>;
+    template<typename Node>
+    using Cursor = DepthFirstCursor<Node, Split>;
+    static constexpr const char *NAME = "traverse_reverse_pre_order";
+};
+
+template<unsigned int D>
+struct OrderTraits<ReversePostOrder, D> {
+    using Split = Mirrored<SplitBefore>;
+    template<typename Node>
+    using Cursor = DepthFirstCursor<Node, Split>;
+    static constexpr const char *NAME = "traverse_reverse_post_order";
+};
+
+template<unsigned int D>
+struct OrderTraits<ReverseBreadthFirst, D> {
+    template<typename Node>
+    using Cursor = ReverseBreadthFirstCursor<Node>;
+    static constexpr const char *NAME = "traverse_reverse_bfs_scan";
+};
+
+template<typename Order, typename Skip, unsigned int D>
+struct OrderTraits<Pruned<Order, Skip>, D> {
+    template<typename Node>
+    using Cursor = DepthFirstCursor<Node, typename OrderTraits<Order, D>::Split, Pruning<Skip>>;
+    static constexpr const char *NAME = "traverse_pruned";
+};
+
+template<typename Skip, unsigned int D>
+struct OrderTraits<Pruned<BreadthFirst, Skip>, D> {
+    template<typename Node>
+    using Cursor = PrunedBreadthFirstCursor<Node, Pruning<Skip>>;
+    static constexpr const char *NAME = "traverse_pruned";
+};
+
+/**
+ * @brief The cursor type of an order on a tree of degree D.
+ */
+template<typename Node, typename Order, unsigned int D>
+using TraversalCursor = typename OrderTraits<Order, D>::template Cursor<Node>;
+
+#if defined(__cpp_lib_ranges)
+template<typename Range>
+using TraversalRangeBase = std::ranges::view_interface<Range>;  ///< Makes TraversalRange a C++20 view.
+#else
+template<typename Range>
+struct TraversalRangeBase {};
+#endif
+
+/**
+ * @brief A traversal as a lazy range, returned by Tree::pre_order(), Tree::bfs() and so on.
+ *
+ * Works with range-for in C++17. With C++20 ranges it is a borrowed view,
+ * so it composes with std::views::filter, transform or take, and only the
+ * nodes actually consumed are visited.
+ *
+ * @tparam Iterator The traversal iterator; its default value is the end.
+ */
+template<typename Iterator>
+class TraversalRange : public TraversalRangeBase<TraversalRange<Iterator>> {
+public:
+    /**
+     * @brief Construct an empty range.
+     */
+    TraversalRange() = default;
+
+    /**
+     * @brief Construct a range from the iterator at its first node.
+     *
+     * @param first The beginning of the traversal.
+     * @param last The end; bidirectional traversals pass one that can step back.
+     */
+    explicit TraversalRange(Iterator first, Iterator last = Iterator()) : first(std::move(first)), last(std::move(last)) {}
+
+    /**
+     * @brief Get an iterator to the first node; each call starts an independent pass.
+     */
+    Iterator begin() const {
+        return first;
+    }
+
+    /**
+     * @brief Get the end iterator.
+     */
+    Iterator end() const {
+        return last;
+    }
+
+private:
+    Iterator first;  ///< The traversal, not yet advanced.
+    Iterator last;   ///< The end position.
+};
+
+#if defined(__cpp_lib_ranges)
+/**
+ * @brief The iterators point into the tree, not into the range, so they outlive it.
+ */
+template<typename Iterator>
+inline constexpr bool std::ranges::enable_borrowed_range<TraversalRange<Iterator>> = true;
+#endif
+
+#endif // TREESITERATORS_CPP_TREETRAVERSAL_HPP
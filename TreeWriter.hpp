@@ -0,0 +1,414 @@
+//oriyati0701@gmail.com
+
+#ifndef TREESITERATORS_CPP_TREEWRITER_HPP
+#define TREESITERATORS_CPP_TREEWRITER_HPP
+
+#include <charconv>  // For std::to_chars
+#include <cmath>     // For std::isfinite
+#include <cstring>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+#include "Complex.hpp"
+#include "Tree.hpp"
+
+/**
+ * @brief A fixed-size output buffer in front of an output stream.
+ *
+ * Formatting code writes straight into the buffer, which is handed to the
+ * stream in large blocks, so writing a tree costs no allocation per node.
+ */
+class BufferedWriter {
+public:
+    static const std::size_t BUFFER_SIZE = 1 << 16;  ///< Bytes collected before each write to the stream.
+
+    /**
+     * @brief Construct a writer over a stream.
+     *
+     * @param out The stream to write to.
+     */
+    explicit BufferedWriter(std::ostream &out) : out(out), buffer(BUFFER_SIZE) {}
+
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+    /**
+     * @brief Flush what is left; errors are reported by flush(), not here.
+     */
+    ~BufferedWriter() {
+        out.write(buffer.data(), static_cast<std::streamsize>(used));
+    }
+
+    /**
+     * @brief Append one character.
+     *
+     * @param c The character to append.
+     */
+    void put(char c) {
+        if (used == buffer.size())
+            drain();
+        buffer[used++] = c;
+    }
+
+    /**
+     * @brief Append a block of bytes.
+     *
+     * @param data The bytes to append.
+     * @param size The number of bytes.
+     */
+    void write(const char *data, std::size_t size) {
+        if (size > buffer.size() - used) {
+            drain();
+            if (size > buffer.size()) {
+                out.write(data, static_cast<std::streamsize>(size));
+                return;
+            }
+        }
+        std::memcpy(buffer.data() + used, data, size);
+        used += size;
+    }
+
+    /**
+     * @brief Append a string.
+     *
+     * @param text The text to append.
+     */
+    void write(std::string_view text) {
+        write(text.data(), text.size());
+    }
+
+    /**
+     * @brief Get room to format into directly; follow with commit().
+     *
+     * @param size The number of bytes needed, at most BUFFER_SIZE.
+     * @return char* Start of at least size free bytes.
+     */
+    char *reserve(std::size_t size) {
+        if (size > buffer.size() - used)
+            drain();
+        return buffer.data() + used;
+    }
+
+    /**
+     * @brief Keep bytes formatted into the space returned by reserve().
+     *
+     * @param end One past the last byte written.
+     */
+    void commit(const char *end) {
+        used = static_cast<std::size_t>(end - buffer.data());
+    }
+
+    /**
+     * @brief Hand everything buffered to the stream and flush it.
+     *
+     * @throws std::runtime_error If the stream is in a failed state.
+     */
+    void flush() {
+        drain();
+        out.flush();
+        if (!out) {
+            throw std::runtime_error("Failed writing tree output.");
+        }
+    }
+
+private:
+    std::ostream &out;          ///< The stream being written.
+    std::vector<char> buffer;   ///< Bytes not yet handed to the stream.
+    std::size_t used = 0;       ///< Number of valid bytes in the buffer.
+
+    /**
+     * @brief Hand the buffered bytes to the stream.
+     */
+    void drain() {
+        out.write(buffer.data(), static_cast<std::streamsize>(used));
+        used = 0;
+    }
+};
+
+/**
+ * @brief Write an arithmetic key with std::to_chars, shortest round-trip form for floating point.
+ *
+ * @tparam B The key type.
+ * @param writer The writer to append to.
+ * @param value The key.
+ */
+template<typename B>
+inline void writeKey(BufferedWriter &writer, const B &value) {
+    static_assert(std::is_arithmetic<B>::value, "writeKey needs an overload for non-arithmetic keys.");
+    char *first = writer.reserve(64);
+    writer.commit(std::to_chars(first, first + 64, value).ptr);
+}
+
+/**
+ * @brief Write a bool key as "true" or "false"; std::to_chars has no bool overload.
+ */
+inline void writeKey(BufferedWriter &writer, bool value) {
+    writer.write(value ? "true" : "false");
+}
+
+/**
+ * @brief Write a string key as is.
+ */
+inline void writeKey(BufferedWriter &writer, const std::string &value) {
+    writer.write(value);
+}
+
+/**
+ * @brief Write a complex key as "a + bi" or "a - bi", which fromString reads back.
+ */
+inline void writeKey(BufferedWriter &writer, const Complex &value) {
+    char *first = writer.reserve(Complex::MAX_CHARS);
+    writer.commit(value.toChars(first, first + Complex::MAX_CHARS));
+}
+
+/**
+ * @brief Write a CachedComplex key like the equal Complex.
+ */
+inline void writeKey(BufferedWriter &writer, const CachedComplex &value) {
+    writeKey(writer, value.toComplex());
+}
+
+/**
+ * @brief Write a key as a double-quoted JSON string.
+ *
+ * Only string keys can contain characters that need escaping.
+ */
+template<typename B>
+inline void writeQuotedKey(BufferedWriter &writer, const B &value) {
+    writer.put('"');
+    writeKey(writer, value);
+    writer.put('"');
+}
+
+/**
+ * @brief Write a string key as a double-quoted string with JSON escapes.
+ */
+inline void writeQuotedKey(BufferedWriter &writer, const std::string &value) {
+    static const char HEX[] = "0123456789abcdef";
+    writer.put('"');
+    for (char c : value) {
+        switch (c) {
+            case '"': writer.write("\\\""); break;
+            case '\\': writer.write("\\\\"); break;
+            case '\n': writer.write("\\n"); break;
+            case '\r': writer.write("\\r"); break;
+            case '\t': writer.write("\\t"); break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    writer.write("\\u00");
+                    writer.put(HEX[(c >> 4) & 0xF]);
+                    writer.put(HEX[c & 0xF]);
+                } else {
+                    writer.put(c);
+                }
+        }
+    }
+    writer.put('"');
+}
+
+/**
+ * @brief Write a DOT label as a double-quoted string; only string keys need escaping.
+ */
+template<typename B>
+inline void writeDotLabel(BufferedWriter &writer, const B &value) {
+    writer.put('"');
+    writeKey(writer, value);
+    writer.put('"');
+}
+
+/**
+ * @brief Write a string DOT label with Graphviz's escapes.
+ *
+ * Quotes and backslashes are escaped and a newline becomes Graphviz's "\n"
+ * line break. DOT has no escape for other control characters, so they are
+ * dropped.
+ */
+inline void writeDotLabel(BufferedWriter &writer, const std::string &value) {
+    writer.put('"');
+    for (char c : value) {
+        switch (c) {
+            case '"': writer.write("\\\""); break;
+            case '\\': writer.write("\\\\"); break;
+            case '\n': writer.write("\\n"); break;
+            default:
+                if (static_cast<unsigned char>(c) >= 0x20 && c != 0x7F)
+                    writer.put(c);
+        }
+    }
+    writer.put('"');
+}
+
+/**
+ * @brief Write a Newick label; numeric and complex labels never need quoting.
+ */
+template<typename B>
+inline void writeNewickLabel(BufferedWriter &writer, const B &value) {
+    writeKey(writer, value);
+}
+
+/**
+ * @brief Write a string Newick label, single-quoted when it contains delimiters.
+ */
+inline void writeNewickLabel(BufferedWriter &writer, const std::string &value) {
+    bool plain = !value.empty() && value.find_first_of("(),:;[]' \t\r\n") == std::string::npos;
+    if (plain) {
+        writer.write(value);
+        return;
+    }
+    writer.put('\'');
+    for (char c : value) {
+        if (c == '\'')
+            writer.put('\'');  // quotes are escaped by doubling them
+        writer.put(c);
+    }
+    writer.put('\'');
+}
+
+/**
+ * @brief Walk a tree in pre-order with an explicit stack of (node, next child) frames.
+ *
+ * Uses memory proportional to the depth only and never recurses, so any
+ * tree shape can be written.
+ *
+ * @tparam Node The node type of the tree.
+ * @tparam Enter Callable as enter(const Node &node, std::size_t index_in_parent).
+ * @tparam Leave Callable as leave(const Node &node) once all children are done.
+ * @param root The root of the walk, may be null.
+ * @param enter Called when a node is first reached.
+ * @param leave Called after the whole subtree of a node.
+ */
+template<typename Node, typename Enter, typename Leave>
+void walk_pre_order(const Node *root, Enter enter, Leave leave) {
+    if (!root)
+        return;
+    std::vector<std::pair<const Node *, std::size_t>> stack;
+    enter(*root, 0);
+    stack.emplace_back(root, 0);
+    while (!stack.empty()) {
+        auto &top = stack.back();
+        if (top.second == top.first->children.size()) {
+            leave(*top.first);
+            stack.pop_back();
+            continue;
+        }
+        std::size_t index = top.second++;
+        const Node *child = top.first->children[index].get();
+        enter(*child, index);
+        stack.emplace_back(child, 0);
+    }
+}
+
+/**
+ * @brief Write a tree as a Graphviz DOT digraph.
+ *
+ * Nodes are named n0, n1, ... in pre-order and labelled with their key.
+ *
+ * @param tree The tree to write.
+ * @param out The stream to write to.
+ * @throws std::runtime_error If writing fails.
+ */
+template<typename T, unsigned int D>
+void write_dot(const Tree<T, D> &tree, std::ostream &out) {
+    using Node = typename Tree<T, D>::Node;
+    BufferedWriter writer(out);
+    std::vector<std::size_t> ids;  // ids of the open ancestors
+    std::size_t next_id = 0;
+    char digits[24];
+    auto write_id = [&](std::size_t id) {
+        writer.put('n');
+        writer.write(digits, static_cast<std::size_t>(std::to_chars(digits, digits + sizeof(digits), id).ptr - digits));
+    };
+
+    writer.write("digraph Tree {\n");
+    walk_pre_order(tree.get_root(), [&](const Node &node, std::size_t) {
+        std::size_t id = next_id++;
+        writer.write("  ");
+        write_id(id);
+        writer.write(" [label=");
+        writeDotLabel(writer, node.key);
+        writer.write("];\n");
+        if (!ids.empty()) {
+            writer.write("  ");
+            write_id(ids.back());
+            writer.write(" -> ");
+            write_id(id);
+            writer.write(";\n");
+        }
+        ids.push_back(id);
+    }, [&](const Node &) {
+        ids.pop_back();
+    });
+    writer.write("}\n");
+    writer.flush();
+}
+
+/**
+ * @brief Write a tree in Newick notation, e.g. "((e)b,(f)c,d)a;", readable by parse_newick.
+ *
+ * @param tree The tree to write.
+ * @param out The stream to write to.
+ * @throws std::runtime_error If writing fails.
+ */
+template<typename T, unsigned int D>
+void write_newick(const Tree<T, D> &tree, std::ostream &out) {
+    using Node = typename Tree<T, D>::Node;
+    BufferedWriter writer(out);
+    walk_pre_order(tree.get_root(), [&](const Node &node, std::size_t index) {
+        if (index > 0)
+            writer.put(',');
+        if (!node.children.empty())
+            writer.put('(');
+    }, [&](const Node &node) {
+        if (!node.children.empty())
+            writer.put(')');
+        writeNewickLabel(writer, node.key);
+    });
+    if (tree.get_root())
+        writer.write(";\n");
+    writer.flush();
+}
+
+/**
+ * @brief Write a tree as nested {"key": ..., "children": [...]} objects, readable by parse_json.
+ *
+ * Arithmetic keys are written as JSON numbers (bool as true or false),
+ * other keys as strings. JSON has no NaN or infinity, so a floating-point
+ * key that is not finite is rejected rather than written as an invalid
+ * token or a null that would not read back.
+ *
+ * @param tree The tree to write.
+ * @param out The stream to write to.
+ * @throws std::runtime_error If a key is NaN or infinite, or writing fails.
+ */
+template<typename T, unsigned int D>
+void write_json(const Tree<T, D> &tree, std::ostream &out) {
+    using Node = typename Tree<T, D>::Node;
+    BufferedWriter writer(out);
+    walk_pre_order(tree.get_root(), [&](const Node &node, std::size_t index) {
+        if (index > 0)
+            writer.put(',');
+        writer.write("{\"key\":");
+        if constexpr (std::is_floating_point<T>::value) {
+            if (!std::isfinite(node.key))
+                throw std::runtime_error("JSON cannot represent the key " + std::to_string(node.key) + ".");
+        }
+        if constexpr (std::is_arithmetic<T>::value)
+            writeKey(writer, node.key);
+        else
+            writeQuotedKey(writer, node.key);
+        if (!node.children.empty())
+            writer.write(",\"children\":[");
+    }, [&](const Node &node) {
+        if (!node.children.empty())
+            writer.put(']');
+        writer.put('}');
+    });
+    if (tree.get_root())
+        writer.put('\n');
+    writer.flush();
+}
+
+#endif // TREESITERATORS_CPP_TREEWRITER_HPP